@@ -1,4 +1,5 @@
 const API_BASE_URL = process.env.REACT_APP_API_BASE_URL || 'https://safedrive-backend-4h5k.onrender.com';
+const STREAM_URL = process.env.REACT_APP_STREAM_URL;
 
 async function fetchWithTimeout(url, options = {}, timeout = 5000, signal) {
   const controller = new AbortController();
@@ -72,6 +73,56 @@ async function handleApiRequest(endpoint, method = 'GET', data = null, signal) {
   }
 }
 
+// One WebSocket to the device's real-time frames (5-10 Hz), shared by every
+// subscriber: it opens with the first subscription, reconnects while any
+// remain and closes with the last.
+const streamListeners = new Set();
+let streamSocket = null;
+let streamRetryTimer = null;
+
+function connectSensorStream() {
+  streamRetryTimer = null;
+  const socket = new WebSocket(STREAM_URL);
+  streamSocket = socket;
+  socket.onmessage = (event) => {
+    let frame;
+    try {
+      frame = JSON.parse(event.data);
+    } catch (err) {
+      console.error('Invalid stream frame:', err);
+      return;
+    }
+    if (frame.t !== 'sensor') return;
+    streamListeners.forEach((listener) => listener(frame));
+  };
+  socket.onclose = () => {
+    if (streamSocket !== socket) return;
+    streamSocket = null;
+    if (streamListeners.size > 0) streamRetryTimer = setTimeout(connectSensorStream, 2000);
+  };
+}
+
+// Subscribes to the shared sensor stream. Returns an unsubscribe function, or
+// null when no stream endpoint is configured.
+function subscribeSensorStream(onFrame) {
+  if (!STREAM_URL || typeof WebSocket === 'undefined') return null;
+
+  const listener = (frame) => onFrame(frame);
+  streamListeners.add(listener);
+  if (!streamSocket && !streamRetryTimer) connectSensorStream();
+
+  return () => {
+    if (!streamListeners.delete(listener) || streamListeners.size > 0) return;
+    clearTimeout(streamRetryTimer);
+    streamRetryTimer = null;
+    if (streamSocket) {
+      const socket = streamSocket;
+      streamSocket = null;
+      socket.close();
+    }
+  };
+}
+
 const api = {
   getLatestSensorData: (signal) => handleApiRequest('/api/sensor', 'GET', null, signal),
   getHealth: (signal) => handleApiRequest('/api/health', 'GET', null, signal),
@@ -79,7 +130,8 @@ const api = {
   getAccidents: (signal) => handleApiRequest('/api/accidents', 'GET', null, signal),
   getCarPosition: (signal) => handleApiRequest('/api/position', 'GET', null, signal), // Changed endpoint
   getSensorHistory: (signal) => handleApiRequest('/api/sensor/history', 'GET', null, signal),
-  postSensorData: (data, signal) => handleApiRequest('/api/sensor', 'POST', data, signal)
+  postSensorData: (data, signal) => handleApiRequest('/api/sensor', 'POST', data, signal),
+  subscribeSensorStream
 };
 
 export default api;
\ No newline at end of file
@@ -7,6 +7,7 @@ import HeartRateCard from './HeartRateCard';
 import AccidentImpactTable from './AccidentImpactTable'; // Import the new component
 import ConnectionStatusButton from './ConnectionStatusButton'; // Import the new component
 import RealTimeSensor from './RealTimeSensor';
+import PipelineLatency from './PipelineLatency';
 import api from '../api';
 
 function AnimatedStat({ children, delay = 0 }) {
@@ -213,6 +214,9 @@ export default function DashboardHome() {
           <Grid item xs={12}>
             <RealTimeSensor />
           </Grid>
+          <Grid item xs={12}>
+            <PipelineLatency />
+          </Grid>
         </Grid>
         {/* Animated Divider Bottom */}
         <Box sx={{width:'100%',maxWidth:1400,mb:4,position:'relative',zIndex:2}}>
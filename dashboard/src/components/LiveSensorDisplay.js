@@ -18,7 +18,14 @@ export default function LiveSensorDisplay() {
 
     fetchData();
     const interval = setInterval(fetchData, 2000);
-    return () => clearInterval(interval);
+    // Stream frames update the live fields between polls
+    const unsubscribe = api.subscribeSensorStream((frame) => {
+      setData((prev) => ({ ...prev, ...frame }));
+    });
+    return () => {
+      clearInterval(interval);
+      if (unsubscribe) unsubscribe();
+    };
   }, []);
 
   if (!data) return null;
@@ -0,0 +1,88 @@
+import React, { useEffect, useState } from 'react';
+import { Box, Card, CardContent, Typography, Alert } from '@mui/material';
+import { LineChart, Line, XAxis, YAxis, CartesianGrid, Tooltip, Legend, ResponsiveContainer } from 'recharts';
+import api from '../api';
+
+const MAX_POINTS = 120;
+
+// Stream frames carry their capture and send times in device UTC (utc_us,
+// sent_utc_us); the stream server may add its receive time (server_utc_us).
+// Against this browser's clock they split the sensor-to-screen latency into
+// time on the device, on the network and in the relay. Only meaningful while
+// both clocks are synced (GPS/NTP on the device, NTP on this computer).
+function latencyPoint(frame, receivedUs) {
+  const ms = (us) => Math.round(us / 100) / 10;
+  const point = {
+    time: new Date(frame.utc_us / 1000).toLocaleTimeString(),
+    device: ms(frame.sent_utc_us - frame.utc_us),
+    total: ms(receivedUs - frame.utc_us),
+  };
+  if (frame.server_utc_us) {
+    point.uplink = ms(frame.server_utc_us - frame.sent_utc_us);
+    point.relay = ms(receivedUs - frame.server_utc_us);
+  } else {
+    point.network = ms(receivedUs - frame.sent_utc_us);
+  }
+  return point;
+}
+
+export default function PipelineLatency() {
+  const [points, setPoints] = useState([]);
+  const [uncertaintyMs, setUncertaintyMs] = useState(null);
+
+  useEffect(() => {
+    const unsubscribe = api.subscribeSensorStream((frame) => {
+      if (!frame.utc_us || !frame.sent_utc_us) return;
+      const point = latencyPoint(frame, Date.now() * 1000);
+      setUncertaintyMs(frame.clock_uncertainty_us / 1000);
+      setPoints((prev) => [...prev.slice(-(MAX_POINTS - 1)), point]);
+    });
+    return () => {
+      if (unsubscribe) unsubscribe();
+    };
+  }, []);
+
+  const relayed = points.some((p) => p.uplink !== undefined);
+  const latest = points[points.length - 1];
+
+  return (
+    <Card>
+      <CardContent>
+        <Typography variant="h5" gutterBottom>Pipeline Latency</Typography>
+        {points.length === 0 ? (
+          <Alert severity="info">
+            Waiting for time-stamped stream frames (the device clock syncs from GPS or NTP)
+          </Alert>
+        ) : (
+          <>
+            <Typography variant="body2" color="text.secondary" gutterBottom>
+              Sensor to screen {latest.total} ms, on device {latest.device} ms
+              {uncertaintyMs !== null && ` (device clock ±${uncertaintyMs} ms)`}
+            </Typography>
+            <Box height={300}>
+              <ResponsiveContainer width="100%" height="100%">
+                <LineChart data={points}>
+                  <CartesianGrid strokeDasharray="3 3" />
+                  <XAxis dataKey="time" minTickGap={40} />
+                  <YAxis unit=" ms" />
+                  <Tooltip />
+                  <Legend />
+                  <Line type="monotone" dataKey="total" name="Sensor to screen" stroke="#d32f2f" dot={false} isAnimationActive={false} />
+                  <Line type="monotone" dataKey="device" name="On device" stroke="#1976d2" dot={false} isAnimationActive={false} />
+                  {relayed ? (
+                    <Line type="monotone" dataKey="uplink" name="Device to server" stroke="#2e7d32" dot={false} isAnimationActive={false} />
+                  ) : (
+                    <Line type="monotone" dataKey="network" name="Network" stroke="#2e7d32" dot={false} isAnimationActive={false} />
+                  )}
+                  {relayed && (
+                    <Line type="monotone" dataKey="relay" name="Server to screen" stroke="#ed6c02" dot={false} isAnimationActive={false} />
+                  )}
+                </LineChart>
+              </ResponsiveContainer>
+            </Box>
+          </>
+        )}
+      </CardContent>
+    </Card>
+  );
+}
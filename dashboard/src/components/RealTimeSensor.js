@@ -31,8 +31,13 @@ export default function RealTimeSensor() {
 
     fetchData();
     const interval = setInterval(fetchData, 2000);
+    // Stream frames update the live fields between polls
+    const unsubscribe = api.subscribeSensorStream((frame) => {
+      setData((prev) => ({ ...prev, ...frame }));
+    });
     return () => {
       clearInterval(interval);
+      if (unsubscribe) unsubscribe();
       if (abortControllerRef.current) {
         abortControllerRef.current.abort();
       }
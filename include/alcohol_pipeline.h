@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// MQ-3 alcohol decision from a stream of raw ADC samples, constant time per
+// sample. The source of the samples is the caller's: the firmware feeds the
+// live ADC, tools/trace_replay.cpp feeds recorded traces.
+//
+// Per sample:
+//   1. Temperature compensation. The MQ-3's resistance falls as it warms, so
+//      the same air reads higher; the reading is divided by
+//      1 + tempCoeff * (T - refTemp). Skipped while the temperature is unknown.
+//   2. Smoothing, an EWMA with time constant smoothMs.
+//   3. Baseline, a slow EWMA of the smoothed reading in clean air, capped at
+//      baselineMax. It falls with a reading below it over baselineMs but only
+//      rises over baselineRiseMs, hours, so it follows heater ageing and
+//      humidity drift while a slow exposure still rises against it. It is
+//      frozen once the rise reaches clearRiseCounts and while alcohol is
+//      detected.
+//   4. Decision: alcohol when the reading is riseCounts above the baseline or
+//      at the absolute threshold, clear again below clearRiseCounts (and the
+//      threshold). A new decision must hold for debounceMs before the state
+//      changes.
+//
+// Warm-up: a cold heater reads high and decays for tens of seconds after
+// power-on. No decision is made until at least warmupMinMs have passed and
+// the reading has settled (it stays within settleCounts of its own
+// baselineWarmupMs average), or warmupMaxMs have passed regardless. The
+// baseline starts from that average, capped, so alcohol already in the cabin
+// at power-on is still detected once warm-up ends.
+
+enum AlcoholState : uint8_t {
+  ALCOHOL_WARMING_UP,
+  ALCOHOL_CLEAR,
+  ALCOHOL_DETECTED
+};
+
+struct AlcoholConfig {
+  uint32_t warmupMinMs;
+  uint32_t warmupMaxMs;
+  float settleCounts;        // Warm-up ends once the reading is this close to its average
+  float smoothMs;            // Reading EWMA time constant
+  float baselineWarmupMs;    // Baseline time constant during warm-up
+  float baselineMs;          // Baseline time constant afterwards, falling
+  float baselineRiseMs;      // Baseline time constant afterwards, rising
+  float baselineMax;         // Clean air never reads higher than this
+  float riseCounts;          // Rise over the baseline that counts as alcohol
+  float clearRiseCounts;     // Rise below which the air is clear again
+  float thresholdCounts;     // Absolute level that counts as alcohol whatever the baseline
+  uint32_t debounceMs;
+  float refTempC;
+  float tempCoeff;           // Reading gain per degree C above refTempC
+};
+
+struct AlcoholStats {
+  uint32_t samples;
+  uint32_t warmupMs;         // Power-on to the end of warm-up, 0 while warming up
+  uint32_t detections;       // Transitions to ALCOHOL_DETECTED
+  uint32_t rejected;         // Decisions that did not outlast the debounce
+  uint64_t detectedMs;       // Time spent in ALCOHOL_DETECTED
+};
+
+class AlcoholPipeline {
+ public:
+  explicit AlcoholPipeline(const AlcoholConfig &config) : config_(config) {}
+
+  // One ADC sample at nowMs; tempC is NAN when unknown
+  AlcoholState update(uint32_t nowMs, int raw, float tempC) {
+    float reading = (float)raw;
+    if (!std::isnan(tempC)) {
+      const float gain = 1.0f + config_.tempCoeff * (tempC - config_.refTempC);
+      if (gain > 0.5f) reading /= gain;
+    }
+    stats_.samples++;
+
+    if (stats_.samples == 1) {
+      startMs_ = lastMs_ = nowMs;
+      level_ = trend_ = reading;
+      baseline_ = reading < config_.baselineMax ? reading : config_.baselineMax;
+      return state_;
+    }
+    const float dt = (float)(nowMs - lastMs_);
+    lastMs_ = nowMs;
+    level_ += alpha(dt, config_.smoothMs) * (reading - level_);
+
+    if (state_ == ALCOHOL_WARMING_UP) {
+      trend_ += alpha(dt, config_.baselineWarmupMs) * (level_ - trend_);
+      baseline_ = trend_ < config_.baselineMax ? trend_ : config_.baselineMax;
+      const uint32_t elapsed = nowMs - startMs_;
+      const float gap = level_ - trend_;
+      const bool settled = gap < config_.settleCounts && gap > -config_.settleCounts;
+      if ((elapsed >= config_.warmupMinMs && settled) || elapsed >= config_.warmupMaxMs) {
+        stats_.warmupMs = elapsed;
+        state_ = ALCOHOL_CLEAR;
+        pendingSinceMs_ = nowMs;
+      }
+      return state_;
+    }
+
+    const float rise = level_ - baseline_;
+    if (state_ == ALCOHOL_DETECTED) stats_.detectedMs += (uint32_t)dt;
+    if (state_ == ALCOHOL_CLEAR && rise < config_.clearRiseCounts) {
+      trackBaseline(dt, rise > 0 ? config_.baselineRiseMs : config_.baselineMs);
+    }
+
+    const bool alcohol = level_ >= config_.thresholdCounts || rise >= config_.riseCounts;
+    const bool clear = level_ < config_.thresholdCounts && rise < config_.clearRiseCounts;
+    const bool change = state_ == ALCOHOL_CLEAR ? alcohol : clear;
+    if (!change) {
+      if (pending_) stats_.rejected++;
+      pending_ = false;
+      pendingSinceMs_ = nowMs;
+      return state_;
+    }
+    pending_ = true;
+    if (nowMs - pendingSinceMs_ >= config_.debounceMs) {
+      state_ = state_ == ALCOHOL_CLEAR ? ALCOHOL_DETECTED : ALCOHOL_CLEAR;
+      if (state_ == ALCOHOL_DETECTED) stats_.detections++;
+      pending_ = false;
+      pendingSinceMs_ = nowMs;
+    }
+    return state_;
+  }
+
+  AlcoholState state() const { return state_; }
+  bool detected() const { return state_ == ALCOHOL_DETECTED; }
+  // Smoothed, temperature-compensated reading in ADC counts
+  float level() const { return level_; }
+  float baseline() const { return baseline_; }
+  const AlcoholStats &stats() const { return stats_; }
+
+ private:
+  static float alpha(float dtMs, float tauMs) {
+    return dtMs >= tauMs ? 1.0f : dtMs / tauMs;
+  }
+
+  void trackBaseline(float dtMs, float tauMs) {
+    baseline_ += alpha(dtMs, tauMs) * (level_ - baseline_);
+    if (baseline_ > config_.baselineMax) baseline_ = config_.baselineMax;
+  }
+
+  const AlcoholConfig config_;
+  AlcoholState state_ = ALCOHOL_WARMING_UP;
+  float level_ = 0;
+  float baseline_ = 0;
+  float trend_ = 0;          // Uncapped reading average, during warm-up
+  uint32_t startMs_ = 0;
+  uint32_t lastMs_ = 0;
+  uint32_t pendingSinceMs_ = 0;
+  bool pending_ = false;
+  AlcoholStats stats_ = {};
+};
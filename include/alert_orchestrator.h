@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bookkeeping for emergency alerts. AlertGate decides on the control core
+// whether a confirmed accident raises a new alert. AlertTimeline timestamps
+// each notification channel of the active alert (one SMS per contact, the
+// voice call, the backend event) so the delay from detection to each
+// notification can be reported. Channels are written from different tasks,
+// so the per-channel fields are atomic.
+
+#define ALERT_MAX_CHANNELS 8
+
+enum AlertChannelState : uint8_t {
+  ALERT_CHANNEL_IDLE = 0,
+  ALERT_CHANNEL_PENDING = 1,     // Alert raised, channel not started yet
+  ALERT_CHANNEL_STARTED = 2,     // Request handed to the modem or the network
+  ALERT_CHANNEL_DELIVERED = 3,   // Accepted by the network / acknowledged
+  ALERT_CHANNEL_FAILED = 4,
+  ALERT_CHANNEL_SKIPPED = 5      // Duplicate contact, nothing sent
+};
+
+// One alert per ACCIDENT_COOLDOWN, unless the accident escalates to a higher level
+class AlertGate {
+ public:
+  explicit AlertGate(uint32_t cooldownMs) : cooldownMs_(cooldownMs) {}
+
+  bool admit(int level, uint32_t nowMs) {
+    if (level <= 0) return false;
+    if (alerts_.load(std::memory_order_relaxed) > 0 && nowMs - lastMs_ < cooldownMs_ && level <= level_) {
+      suppressed_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    lastMs_ = nowMs;
+    level_ = level;
+    alerts_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Counters may be read from any task
+  uint32_t alerts() const { return alerts_.load(std::memory_order_relaxed); }
+  uint32_t suppressed() const { return suppressed_.load(std::memory_order_relaxed); }
+
+ private:
+  const uint32_t cooldownMs_;
+  uint32_t lastMs_ = 0;
+  int level_ = 0;
+  std::atomic<uint32_t> alerts_{0};
+  std::atomic<uint32_t> suppressed_{0};
+};
+
+class AlertTimeline {
+ public:
+  // Starts a new alert; every channel below `channels` becomes pending
+  void begin(uint32_t detectUs, uint32_t dispatchUs, size_t channels) {
+    channels_ = channels < ALERT_MAX_CHANNELS ? channels : ALERT_MAX_CHANNELS;
+    detectUs_.store(detectUs, std::memory_order_relaxed);
+    dispatchUs_.store(dispatchUs, std::memory_order_relaxed);
+    for (size_t i = 0; i < ALERT_MAX_CHANNELS; i++) {
+      startedUs_[i].store(0, std::memory_order_relaxed);
+      doneUs_[i].store(0, std::memory_order_relaxed);
+      state_[i].store(i < channels_ ? ALERT_CHANNEL_PENDING : ALERT_CHANNEL_IDLE, std::memory_order_release);
+    }
+  }
+
+  void started(size_t channel, uint32_t nowUs) {
+    startedUs_[channel].store(nowUs, std::memory_order_relaxed);
+    state_[channel].store(ALERT_CHANNEL_STARTED, std::memory_order_release);
+  }
+
+  void delivered(size_t channel, uint32_t nowUs) { finish(channel, nowUs, ALERT_CHANNEL_DELIVERED); }
+  void failed(size_t channel, uint32_t nowUs) { finish(channel, nowUs, ALERT_CHANNEL_FAILED); }
+  void skipped(size_t channel, uint32_t nowUs) { finish(channel, nowUs, ALERT_CHANNEL_SKIPPED); }
+
+  AlertChannelState state(size_t channel) const {
+    return (AlertChannelState)state_[channel].load(std::memory_order_acquire);
+  }
+
+  // Detection to delivery, or -1 if the channel has not delivered
+  int32_t latencyUs(size_t channel) const {
+    if (state(channel) != ALERT_CHANNEL_DELIVERED) return -1;
+    return (int32_t)(doneUs_[channel].load(std::memory_order_relaxed) - detectUs_.load(std::memory_order_relaxed));
+  }
+
+  // Detection to the channel's request leaving the device, or -1
+  int32_t startLatencyUs(size_t channel) const {
+    if (state(channel) < ALERT_CHANNEL_STARTED) return -1;
+    const uint32_t started = startedUs_[channel].load(std::memory_order_relaxed);
+    if (started == 0) return -1;
+    return (int32_t)(started - detectUs_.load(std::memory_order_relaxed));
+  }
+
+  // Detection to the alert being picked up on the network core
+  int32_t dispatchLatencyUs() const {
+    return (int32_t)(dispatchUs_.load(std::memory_order_relaxed) - detectUs_.load(std::memory_order_relaxed));
+  }
+
+  // Detection to the first delivered notification on any channel, or -1
+  int32_t firstNotificationUs() const {
+    int32_t first = -1;
+    for (size_t i = 0; i < channels_; i++) {
+      const int32_t latency = latencyUs(i);
+      if (latency >= 0 && (first < 0 || latency < first)) first = latency;
+    }
+    return first;
+  }
+
+  // True once no channel is pending or in progress
+  bool complete() const {
+    for (size_t i = 0; i < channels_; i++) {
+      const AlertChannelState s = state(i);
+      if (s == ALERT_CHANNEL_PENDING || s == ALERT_CHANNEL_STARTED) return false;
+    }
+    return true;
+  }
+
+  size_t channels() const { return channels_; }
+
+ private:
+  void finish(size_t channel, uint32_t nowUs, AlertChannelState s) {
+    doneUs_[channel].store(nowUs, std::memory_order_relaxed);
+    state_[channel].store(s, std::memory_order_release);
+  }
+
+  size_t channels_ = 0;
+  std::atomic<uint32_t> detectUs_{0};
+  std::atomic<uint32_t> dispatchUs_{0};
+  std::atomic<uint32_t> startedUs_[ALERT_MAX_CHANNELS] = {};
+  std::atomic<uint32_t> doneUs_[ALERT_MAX_CHANNELS] = {};
+  std::atomic<uint8_t> state_[ALERT_MAX_CHANNELS] = {};
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+// Micro-benchmark helpers shared by the firmware (SAFEDRIVE_BENCH builds) and
+// tools/host_bench.cpp. Results are reported in CPU cycles per call.
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <Arduino.h>
+typedef uint32_t bench_cycles_t;
+inline bench_cycles_t bench_cycles() { return ESP.getCycleCount(); }
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+typedef uint64_t bench_cycles_t;
+inline bench_cycles_t bench_cycles() { return __rdtsc(); }
+#else
+#include <chrono>
+typedef uint64_t bench_cycles_t;  // Nanoseconds where no cycle counter is available
+inline bench_cycles_t bench_cycles() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+// Keeps the optimizer from discarding a benchmarked result
+template <typename T>
+inline void bench_keep(const T &value) {
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Average cycles per fn(i) call over `iterations` calls. On the ESP32 the
+// 32-bit counter wraps every ~18 s at 240 MHz, so keep runs well below that.
+template <typename Fn>
+inline double bench_cycles_per_call(uint32_t iterations, Fn &&fn) {
+  const bench_cycles_t start = bench_cycles();
+  for (uint32_t i = 0; i < iterations; i++) {
+    fn(i);
+  }
+  const bench_cycles_t elapsed = bench_cycles() - start;
+  return iterations ? (double)elapsed / iterations : 0.0;
+}
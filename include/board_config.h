@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+// Pin maps per board variant. Select one with -DSAFEDRIVE_BOARD=... (see
+// platformio.ini); everything that depends on the board reads `Board`.
+//
+// The masks describe what the module allows, one bit per GPIO:
+//   reservedPins   taken by flash or PSRAM, never usable
+//   inputOnlyPins  no output driver
+//   adcPins        usable for analogRead() while WiFi is running (ADC1)
+
+#define SAFEDRIVE_BOARD_ESP32DEV 1   // ESP32-WROOM-32 DevKit
+#define SAFEDRIVE_BOARD_WROVER 2     // ESP32-WROVER, GPIO 16/17 drive the PSRAM
+
+#ifndef SAFEDRIVE_BOARD
+#define SAFEDRIVE_BOARD SAFEDRIVE_BOARD_ESP32DEV
+#endif
+
+constexpr uint64_t board_pin_bit(uint8_t pin) { return 1ull << pin; }
+
+constexpr uint64_t board_pin_range(uint8_t first, uint8_t last) {
+  return first > last ? 0 : board_pin_bit(first) | board_pin_range(first + 1, last);
+}
+
+// Common to every ESP32 module
+struct Esp32Pins {
+  static constexpr uint8_t pinCount = 40;
+  static constexpr uint64_t flashPins = board_pin_range(6, 11);
+  static constexpr uint64_t inputOnlyPins = board_pin_range(34, 39);
+  static constexpr uint64_t adcPins = board_pin_range(32, 39);
+};
+
+template <int Variant>
+struct BoardConfig;
+
+template <>
+struct BoardConfig<SAFEDRIVE_BOARD_ESP32DEV> : Esp32Pins {
+  static constexpr const char *name = "esp32dev";
+  static constexpr uint64_t reservedPins = flashPins;
+
+  static constexpr uint8_t i2cSda = 21;
+  static constexpr uint8_t i2cScl = 22;
+  static constexpr uint8_t gpsRx = 26;        // GPS TX -> ESP32 RX
+  static constexpr uint8_t gpsTx = 5;
+  static constexpr uint8_t gsmRx = 27;        // GSM TX -> ESP32 RX
+  static constexpr uint8_t gsmTx = 19;
+  static constexpr uint8_t pulse = 33;
+  static constexpr uint8_t wifiLed = 2;
+  static constexpr uint8_t hall = 35;
+  static constexpr uint8_t mq3 = 32;
+  static constexpr uint8_t alcoholLed = 0;
+  static constexpr uint8_t vibration = 34;
+  static constexpr uint8_t ultrasonicTrig = 13;
+  static constexpr uint8_t ultrasonicEcho = 14;
+  static constexpr uint8_t distanceLed = 4;
+  static constexpr uint8_t motorIn1 = 16;
+  static constexpr uint8_t motorIn2 = 15;
+  static constexpr uint8_t motorIn3 = 23;
+  static constexpr uint8_t motorIn4 = 17;
+};
+
+// Same wiring, with the two motor pins on 16/17 moved off the PSRAM lines
+template <>
+struct BoardConfig<SAFEDRIVE_BOARD_WROVER> : BoardConfig<SAFEDRIVE_BOARD_ESP32DEV> {
+  static constexpr const char *name = "esp32-wrover";
+  static constexpr uint64_t reservedPins = flashPins | board_pin_bit(16) | board_pin_bit(17);
+
+  static constexpr uint8_t motorIn1 = 18;
+  static constexpr uint8_t motorIn4 = 25;
+};
+
+using Board = BoardConfig<SAFEDRIVE_BOARD>;
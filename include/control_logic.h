@@ -0,0 +1,92 @@
+#pragma once
+
+// Detection and control thresholds plus the pure decision functions built on
+// them. Kept free of Arduino dependencies so tools/trace_replay.cpp runs the
+// exact logic the firmware runs.
+
+#include "alcohol_pipeline.h"
+#include "vibration_features.h"
+
+// Obstacle distance bands (cm)
+#define SAFE_DISTANCE 200      // Increased safe distance to 2 meters
+#define WARNING_DISTANCE 150   // Early warning at 1.5 meters
+#define CRITICAL_DISTANCE 100  // Critical warning at 1 meter
+#define EMERGENCY_DISTANCE 50  // Emergency stop at 50cm
+
+#define RAPID_DECEL_THRESHOLD 3.0    // Sudden deceleration threshold in g
+#define ALCOHOL_THRESHOLD 500    // Reduced from 1000 to 500 for better sensitivity
+#define ACCIDENT_THRESHOLD 3000  // Adjust based on your sensor
+
+// MQ-3 alcohol pipeline (alcohol_pipeline.h); ALCOHOL_THRESHOLD stays the absolute limit
+#define ALCOHOL_WARMUP_MIN 20000      // Cold heater readings are meaningless for at least 20 s (ms)
+#define ALCOHOL_WARMUP_MAX 180000     // Decide after 3 minutes even if the reading never settled (ms)
+#define ALCOHOL_SETTLE_COUNTS 15      // Warm-up ends once the reading is this steady (ADC counts)
+#define ALCOHOL_SMOOTH_MS 500         // Reading EWMA time constant (ms)
+#define ALCOHOL_BASELINE_WARMUP_MS 5000    // Baseline follows the heater's decay during warm-up (ms)
+#define ALCOHOL_BASELINE_MS 600000    // Then falls with clean air over ~10 minutes (ms)
+#define ALCOHOL_BASELINE_RISE_MS 14400000  // and rises over ~4 hours, slower than any exposure (ms)
+#define ALCOHOL_BASELINE_MAX 400      // Clean air never reads higher, even if the cabin smells at boot
+#define ALCOHOL_RISE 150              // Rise over the baseline that counts as alcohol (ADC counts)
+#define ALCOHOL_CLEAR_RISE 80         // Back under this rise the air is clear again
+#define ALCOHOL_DEBOUNCE 2000         // A new decision must hold this long (ms)
+#define ALCOHOL_REF_TEMP 20.0f        // MQ-3 datasheet reference temperature (C)
+#define ALCOHOL_TEMP_COEFF 0.005f     // Reading gain per C; the MPU6050 die tracks the enclosure
+
+// Crash confirmation
+#define IMPACT_THRESHOLD_LOW 3.0   // Light impact (g)
+#define IMPACT_THRESHOLD_HIGH 6.0  // Severe impact (g)
+#define TILT_THRESHOLD_ROLL 45.0  // Roll threshold (degrees)
+#define TILT_THRESHOLD_PITCH 30.0 // Pitch threshold (degrees)
+#define ACCIDENT_LEVEL_1 1    // Ultrasonic + Vibration
+#define ACCIDENT_LEVEL_2 2    // All sensors triggered
+
+// Vibration window analysis
+#define VIBRATION_WINDOW 256         // Samples per analysis window (256 ms)
+#define VIBRATION_ROUGH_RMS 150.0f   // AC RMS in ADC counts treated as rough road
+// Band edges (Hz): body/suspension, road texture, drivetrain, impact ringing
+const float vibrationBandEdges[VIBRATION_BANDS + 1] = {4.0f, 25.0f, 80.0f, 200.0f, 500.0f};
+
+// Motor PWM (0-255) for an obstacle `distance` cm ahead: stop inside
+// EMERGENCY_DISTANCE, linear ramp up to WARNING_DISTANCE, full speed beyond
+inline int motor_speed_for_distance(long distance) {
+  if (distance <= EMERGENCY_DISTANCE) return 0;
+  if (distance >= WARNING_DISTANCE) return 255;
+  return (int)((distance - EMERGENCY_DISTANCE) * 255 / (WARNING_DISTANCE - EMERGENCY_DISTANCE));
+}
+
+inline bool is_rapid_decel(float longitudinalAccel) {
+  return longitudinalAccel < -RAPID_DECEL_THRESHOLD;
+}
+
+inline bool is_alcohol_detected(int alcoholLevel) {
+  return alcoholLevel >= ALCOHOL_THRESHOLD;
+}
+
+inline AlcoholConfig alcohol_config() {
+  return {ALCOHOL_WARMUP_MIN, ALCOHOL_WARMUP_MAX, ALCOHOL_SETTLE_COUNTS, ALCOHOL_SMOOTH_MS,
+          ALCOHOL_BASELINE_WARMUP_MS, ALCOHOL_BASELINE_MS, ALCOHOL_BASELINE_RISE_MS, ALCOHOL_BASELINE_MAX,
+          ALCOHOL_RISE, ALCOHOL_CLEAR_RISE, ALCOHOL_THRESHOLD, ALCOHOL_DEBOUNCE,
+          ALCOHOL_REF_TEMP, ALCOHOL_TEMP_COEFF};
+}
+
+inline uint8_t classify_vibration(const VibrationFeatures &features) {
+  if (features.peak >= ACCIDENT_THRESHOLD) return ROAD_IMPACT;
+  if (features.rms >= VIBRATION_ROUGH_RMS) return ROAD_ROUGH;
+  return ROAD_SMOOTH;
+}
+
+// Accident level from the current readings, 0 when there is none. Level 1 is
+// an obstacle at emergency range together with an impact-class vibration
+// window. Level 2 adds a severe impact or a tilt past the rollover limits,
+// or is a severe impact while tilted with no obstacle in front (rollover,
+// side or rear hit).
+inline int accident_level(long distance, uint8_t roadCondition, float impactG, float rollDeg, float pitchDeg) {
+  const bool obstacle = distance <= EMERGENCY_DISTANCE;
+  const bool shock = roadCondition == ROAD_IMPACT;
+  const bool severe = impactG >= IMPACT_THRESHOLD_HIGH;
+  const bool tilted = rollDeg > TILT_THRESHOLD_ROLL || -rollDeg > TILT_THRESHOLD_ROLL ||
+                      pitchDeg > TILT_THRESHOLD_PITCH || -pitchDeg > TILT_THRESHOLD_PITCH;
+  if (obstacle && shock) return (severe || tilted) ? ACCIDENT_LEVEL_2 : ACCIDENT_LEVEL_1;
+  if (severe && tilted) return ACCIDENT_LEVEL_2;
+  return 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Per-stage execution budgets. Each stage is begun and ended by one task;
+// counters are atomics so another core can report them. When a critical
+// stage misses its budget `missesToShed` times in a row the monitor enters
+// shedding mode, and leaves it once critical stages have met their budgets
+// for `recoveryUs`.
+
+struct DeadlineStageStats {
+  const char *name;
+  uint32_t budgetUs;
+  bool critical;
+  std::atomic<uint32_t> runs{0};
+  std::atomic<uint32_t> misses{0};
+  std::atomic<uint32_t> maxUs{0};
+  uint32_t startUs = 0;
+};
+
+template <size_t MaxStages>
+class DeadlineMonitor {
+ public:
+  DeadlineMonitor(uint32_t missesToShed, uint32_t recoveryUs)
+      : missesToShed_(missesToShed), recoveryUs_(recoveryUs) {}
+
+  // Register before the tasks start. Returns the stage id, or -1 when full.
+  int add(const char *name, uint32_t budgetUs, bool critical) {
+    if (count_ >= MaxStages) return -1;
+    DeadlineStageStats &stage = stages_[count_];
+    stage.name = name;
+    stage.budgetUs = budgetUs;
+    stage.critical = critical;
+    return (int)count_++;
+  }
+
+  void begin(int id, uint32_t nowUs) { stages_[id].startUs = nowUs; }
+
+  // Returns true when the stage finished within its budget
+  bool end(int id, uint32_t nowUs) {
+    DeadlineStageStats &stage = stages_[id];
+    const uint32_t elapsed = nowUs - stage.startUs;
+    stage.runs.fetch_add(1, std::memory_order_relaxed);
+    if (elapsed > stage.maxUs.load(std::memory_order_relaxed)) {
+      stage.maxUs.store(elapsed, std::memory_order_relaxed);
+    }
+
+    const bool missed = elapsed > stage.budgetUs;
+    if (missed) stage.misses.fetch_add(1, std::memory_order_relaxed);
+    if (!stage.critical) return !missed;
+
+    // Critical stages all run on the control task, so this state has one writer
+    if (missed) {
+      consecutiveMisses_++;
+      lastCriticalMissUs_ = nowUs;
+      if (consecutiveMisses_ >= missesToShed_ && !shedding_.load(std::memory_order_relaxed)) {
+        shedding_.store(true, std::memory_order_relaxed);
+        shedEvents_.fetch_add(1, std::memory_order_relaxed);
+      }
+    } else {
+      consecutiveMisses_ = 0;
+      if (shedding_.load(std::memory_order_relaxed) && nowUs - lastCriticalMissUs_ >= recoveryUs_) {
+        shedding_.store(false, std::memory_order_relaxed);
+      }
+    }
+    return !missed;
+  }
+
+  bool shedding() const { return shedding_.load(std::memory_order_relaxed); }
+  uint32_t shedEvents() const { return shedEvents_.load(std::memory_order_relaxed); }
+  size_t stageCount() const { return count_; }
+  const DeadlineStageStats &stage(size_t id) const { return stages_[id]; }
+
+ private:
+  DeadlineStageStats stages_[MaxStages];
+  size_t count_ = 0;
+  const uint32_t missesToShed_;
+  const uint32_t recoveryUs_;
+  uint32_t consecutiveMisses_ = 0;
+  uint32_t lastCriticalMissUs_ = 0;
+  std::atomic<bool> shedding_{false};
+  std::atomic<uint32_t> shedEvents_{0};
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Fast approximations for the IMU math. The ESP32 FPU has single-cycle
+// multiply-add but no hardware divide or square root, so these kernels stay
+// in float and avoid both. The error bounds below are checked by tools/host_bench.cpp.
+
+namespace fastmath {
+
+constexpr float kPi = 3.14159265358979f;
+constexpr float kHalfPi = 1.57079632679490f;
+constexpr float kRadToDeg = 57.2957795130823f;
+
+// 1/sqrt(x), relative error < 1e-6 (one tuned Newton step plus one refinement)
+inline float invSqrt(float x) {
+  uint32_t i;
+  std::memcpy(&i, &x, sizeof(i));
+  i = 0x5f1ffff9u - (i >> 1);
+  float y;
+  std::memcpy(&y, &i, sizeof(y));
+  y *= 0.703952253f * (2.38924456f - x * y * y);
+  return y * (1.5f - 0.5f * x * y * y);
+}
+
+inline float sqrt(float x) {
+  return x > 0.0f ? x * invSqrt(x) : 0.0f;
+}
+
+// atan(z) for |z| <= 1, error < 2e-5 rad
+inline float atanUnit(float z) {
+  const float z2 = z * z;
+  return z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+}
+
+// atan2 in radians, error < 2e-5 rad, one divide
+inline float atan2(float y, float x) {
+  const float ax = x < 0.0f ? -x : x;
+  const float ay = y < 0.0f ? -y : y;
+  if (ax == 0.0f && ay == 0.0f) {
+    return 0.0f;
+  }
+  float angle;
+  if (ay <= ax) {
+    angle = atanUnit(ay / ax);
+  } else {
+    angle = kHalfPi - atanUnit(ax / ay);
+  }
+  if (x < 0.0f) angle = kPi - angle;
+  return y < 0.0f ? -angle : angle;
+}
+
+// asin via atan2, input clamped to [-1, 1]
+inline float asin(float x) {
+  if (x >= 1.0f) return kHalfPi;
+  if (x <= -1.0f) return -kHalfPi;
+  return atan2(x, sqrt(1.0f - x * x));
+}
+
+}  // namespace fastmath
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "spsc_queue.h"
+
+// Priority queues for a shared I2C bus. One task owns the bus and runs the
+// transactions; every other task submits them. Each priority level is an
+// SPSC queue with a single producer task, and the owner always takes the
+// next transaction from the highest level (0) that has one, so urgent
+// traffic waits for at most the one transaction already on the wire.
+//
+// A transaction is a write, optionally followed by a read after a repeated
+// start. Transactions with a read return their bytes on the level's result
+// queue.
+
+#define I2C_MAX_WRITE 16
+#define I2C_MAX_READ 16
+
+struct I2cTransaction {
+  uint32_t clockHz;
+  uint32_t queuedUs;    // Set by submit()
+  uint32_t tag;         // Caller's id, copied to the result
+  void *notify;         // Task to wake when the result is ready, or null
+  uint8_t address;
+  uint8_t writeLength;
+  uint8_t readLength;
+  uint8_t data[I2C_MAX_WRITE];
+};
+
+struct I2cResult {
+  uint32_t tag;
+  uint32_t queuedUs;
+  uint32_t doneUs;
+  uint8_t error;        // Wire status, 0 = ok
+  uint8_t length;
+  uint8_t data[I2C_MAX_READ];
+};
+
+// Per level, since the last takeStats(): all fields may be read from any task
+struct I2cLevelStats {
+  std::atomic<uint32_t> transactions{0};
+  std::atomic<uint32_t> errors{0};
+  std::atomic<uint32_t> busyUs{0};        // Time on the bus
+  std::atomic<uint32_t> latencySumUs{0};  // Queued to done
+  std::atomic<uint32_t> maxLatencyUs{0};
+  std::atomic<uint32_t> maxWaitUs{0};     // Queued to started
+};
+
+struct I2cLevelReport {
+  uint32_t transactions;
+  uint32_t errors;
+  uint32_t busyUs;
+  uint32_t meanLatencyUs;
+  uint32_t maxLatencyUs;
+  uint32_t maxWaitUs;
+};
+
+template <size_t Levels, size_t Depth, size_t ResultDepth = 4>
+class I2cScheduler {
+ public:
+  // Producer side of `level`
+  bool submit(size_t level, I2cTransaction &txn, uint32_t nowUs) {
+    txn.queuedUs = nowUs;
+    return requests_[level].push(txn);
+  }
+
+  // Producer side of `level`: results of its transactions that read
+  bool result(size_t level, I2cResult &out) { return results_[level].pop(out); }
+
+  // Bus owner: the highest-priority pending transaction
+  bool next(I2cTransaction &txn, size_t &level) {
+    for (size_t i = 0; i < Levels; i++) {
+      if (requests_[i].pop(txn)) {
+        level = i;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Bus owner: accounts a finished transaction and hands back what it read
+  void completed(size_t level, const I2cTransaction &txn, uint32_t startUs, uint32_t endUs,
+                 uint8_t error, const uint8_t *data) {
+    I2cLevelStats &stats = stats_[level];
+    stats.transactions.fetch_add(1, std::memory_order_relaxed);
+    if (error) stats.errors.fetch_add(1, std::memory_order_relaxed);
+    stats.busyUs.fetch_add(endUs - startUs, std::memory_order_relaxed);
+    const uint32_t latency = endUs - txn.queuedUs;
+    stats.latencySumUs.fetch_add(latency, std::memory_order_relaxed);
+    store_max(stats.maxLatencyUs, latency);
+    store_max(stats.maxWaitUs, startUs - txn.queuedUs);
+
+    if (txn.readLength == 0) return;
+    I2cResult result;
+    result.tag = txn.tag;
+    result.queuedUs = txn.queuedUs;
+    result.doneUs = endUs;
+    result.error = error;
+    result.length = txn.readLength;
+    if (!error) memcpy(result.data, data, txn.readLength);
+    results_[level].push(result);
+  }
+
+  // Counters for `level` since the previous call, then resets them
+  I2cLevelReport takeStats(size_t level) {
+    I2cLevelStats &stats = stats_[level];
+    I2cLevelReport report;
+    report.transactions = stats.transactions.exchange(0, std::memory_order_relaxed);
+    report.errors = stats.errors.exchange(0, std::memory_order_relaxed);
+    report.busyUs = stats.busyUs.exchange(0, std::memory_order_relaxed);
+    const uint32_t latencySum = stats.latencySumUs.exchange(0, std::memory_order_relaxed);
+    report.meanLatencyUs = report.transactions ? latencySum / report.transactions : 0;
+    report.maxLatencyUs = stats.maxLatencyUs.exchange(0, std::memory_order_relaxed);
+    report.maxWaitUs = stats.maxWaitUs.exchange(0, std::memory_order_relaxed);
+    return report;
+  }
+
+  const SpscQueue<I2cTransaction, Depth> &queue(size_t level) const { return requests_[level]; }
+
+ private:
+  static void store_max(std::atomic<uint32_t> &target, uint32_t value) {
+    uint32_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  SpscQueue<I2cTransaction, Depth> requests_[Levels];
+  SpscQueue<I2cResult, ResultDepth> results_[Levels];
+  I2cLevelStats stats_[Levels];
+};
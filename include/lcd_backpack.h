@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// HD44780 character LCD behind a PCF8574 I2C backpack, wired the way
+// LiquidCrystal_I2C expects: P0 RS, P1 RW, P2 EN, P3 backlight, P4-P7 D4-D7.
+//
+// LcdShadow keeps the text on the glass and the text wanted, and emits one
+// small update per changed cell (a cursor move if needed, then the
+// character), so a redraw is a few short bus transactions instead of a
+// clear and two full lines. Nothing is ever cleared: the clear command
+// alone takes 1.5 ms of controller time.
+
+#define LCD_BACKPACK_RS 0x01
+#define LCD_BACKPACK_EN 0x04
+#define LCD_BACKPACK_BACKLIGHT 0x08
+#define LCD_BACKPACK_SET_DDRAM 0x80
+#define LCD_BACKPACK_MAX_UPDATE 8    // Bytes for a cursor move plus one character
+
+// Four expander writes per byte, each nibble latched on the falling edge of EN
+inline size_t lcd_backpack_encode(uint8_t value, bool isData, uint8_t *out) {
+  const uint8_t flags = LCD_BACKPACK_BACKLIGHT | (isData ? LCD_BACKPACK_RS : 0);
+  const uint8_t high = (value & 0xf0) | flags;
+  const uint8_t low = (uint8_t)(value << 4) | flags;
+  out[0] = high | LCD_BACKPACK_EN;
+  out[1] = high;
+  out[2] = low | LCD_BACKPACK_EN;
+  out[3] = low;
+  return 4;
+}
+
+template <size_t Cols, size_t Rows>
+class LcdShadow {
+  static_assert(Rows <= 4, "HD44780 addresses at most four rows");
+
+ public:
+  LcdShadow() {
+    for (size_t row = 0; row < Rows; row++) set(row, "");
+    invalidate();
+  }
+
+  // Text wanted on `row`; shorter text is padded with blanks
+  void set(size_t row, const char *text) {
+    bool ended = false;
+    for (size_t col = 0; col < Cols; col++) {
+      if (!ended && text[col] == '\0') ended = true;
+      wanted_[row][col] = ended ? ' ' : text[col];
+    }
+  }
+
+  // Glass contents unknown (after init or a bus error): rewrite every cell
+  void invalidate() {
+    for (size_t row = 0; row < Rows; row++) {
+      for (size_t col = 0; col < Cols; col++) shown_[row][col] = 0;
+    }
+    cursorRow_ = Rows;   // Unknown
+  }
+
+  // Expander bytes for the next changed cell, 0 when the glass is up to date.
+  // The cell counts as shown only after commit().
+  size_t nextUpdate(uint8_t *out, size_t &row, size_t &col) const {
+    for (row = 0; row < Rows; row++) {
+      for (col = 0; col < Cols; col++) {
+        if (wanted_[row][col] == shown_[row][col]) continue;
+        size_t length = 0;
+        if (row != cursorRow_ || col != cursorCol_) {
+          length += lcd_backpack_encode(LCD_BACKPACK_SET_DDRAM | (rowOffset(row) + col), false, out);
+        }
+        length += lcd_backpack_encode((uint8_t)wanted_[row][col], true, out + length);
+        return length;
+      }
+    }
+    return 0;
+  }
+
+  void commit(size_t row, size_t col) {
+    shown_[row][col] = wanted_[row][col];
+    cursorRow_ = row;
+    cursorCol_ = col + 1;   // The controller advances after each character
+  }
+
+ private:
+  static uint8_t rowOffset(size_t row) {
+    static const uint8_t offsets[] = {0x00, 0x40, (uint8_t)Cols, (uint8_t)(0x40 + Cols)};
+    return offsets[row];
+  }
+
+  char wanted_[Rows][Cols];
+  char shown_[Rows][Cols];
+  size_t cursorRow_;
+  size_t cursorCol_ = 0;
+};
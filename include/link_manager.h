@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+
+// Non-blocking WiFi connection manager. update() is called periodically with
+// whether the station is connected and returns what the caller should do;
+// the caller owns the radio and the fast-reconnect cache.
+//
+// After a drop the first attempt starts at once. Every attempt starts fast
+// (the cached BSSID, channel and IP lease, skipping the scan and DHCP) when
+// a cache is available, and falls straight through to a full scan with DHCP
+// if that times out; failed scans back off exponentially with jitter. A
+// scan that connects refreshes the cache, so a stale one costs one fast
+// timeout per attempt at most.
+//
+// Metrics: outage duration (drop to connected), association time (attempt
+// start to connected, fast and scan separately) and the share of time up.
+
+enum LinkState : uint8_t {
+  LINK_DOWN,
+  LINK_CONNECTING,
+  LINK_UP,
+  LINK_BACKOFF
+};
+
+enum LinkAction : uint8_t {
+  LINK_ACTION_NONE,
+  LINK_ACTION_CONNECT_FAST,   // Cached BSSID/channel/IP
+  LINK_ACTION_CONNECT_SCAN,   // Full scan and DHCP
+  LINK_ACTION_ABORT           // Stop the attempt in progress
+};
+
+struct LinkStats {
+  uint32_t reconnects;        // Drops followed by a reconnection
+  uint32_t drops;
+  uint32_t lastOutageMs;
+  uint32_t maxOutageMs;
+  uint64_t totalOutageMs;     // Over reconnects, for the mean
+  uint32_t fastAttempts;
+  uint32_t fastConnects;
+  uint64_t fastAssociateMs;   // Over fastConnects
+  uint32_t scanAttempts;
+  uint32_t scanConnects;
+  uint64_t scanAssociateMs;   // Over scanConnects
+  uint64_t upMs;
+  uint64_t trackedMs;
+};
+
+class LinkManager {
+ public:
+  LinkManager(uint32_t fastTimeoutMs, uint32_t scanTimeoutMs, uint32_t backoffMinMs, uint32_t backoffMaxMs)
+      : fastTimeoutMs_(fastTimeoutMs), scanTimeoutMs_(scanTimeoutMs), backoffMinMs_(backoffMinMs),
+        backoffMaxMs_(backoffMaxMs), backoffMs_(backoffMinMs) {}
+
+  // Backoff jitter seed, e.g. from the MAC address, so each device differs
+  void seed(uint32_t value) { random_ = value | 1; }
+
+  LinkAction update(uint32_t nowMs, bool connected, bool haveCache) {
+    if (started_) {
+      const uint32_t elapsed = nowMs - lastUpdateMs_;
+      stats_.trackedMs += elapsed;
+      if (state_ == LINK_UP) stats_.upMs += elapsed;
+    } else {
+      started_ = true;
+      outageStartMs_ = nowMs;
+    }
+    lastUpdateMs_ = nowMs;
+
+    switch (state_) {
+      case LINK_UP:
+        if (connected) return LINK_ACTION_NONE;
+        stats_.drops++;
+        outageStartMs_ = nowMs;
+        hadLink_ = true;
+        return startAttempt(nowMs, haveCache);
+
+      case LINK_DOWN:
+        if (connected) return connectedAt(nowMs);
+        return startAttempt(nowMs, haveCache);
+
+      case LINK_CONNECTING:
+        if (connected) return connectedAt(nowMs);
+        if (nowMs - attemptStartMs_ < (attemptFast_ ? fastTimeoutMs_ : scanTimeoutMs_)) return LINK_ACTION_NONE;
+        if (attemptFast_) return startAttempt(nowMs, false);
+        state_ = LINK_BACKOFF;
+        retryDelayMs_ = jittered(backoffMs_);
+        backoffUntilMs_ = nowMs + retryDelayMs_;
+        backoffMs_ = backoffMs_ * 2 < backoffMaxMs_ ? backoffMs_ * 2 : backoffMaxMs_;
+        return LINK_ACTION_ABORT;
+
+      case LINK_BACKOFF:
+        if (connected) return connectedAt(nowMs);
+        if ((int32_t)(nowMs - backoffUntilMs_) < 0) return LINK_ACTION_NONE;
+        return startAttempt(nowMs, haveCache);
+    }
+    return LINK_ACTION_NONE;
+  }
+
+  LinkState state() const { return state_; }
+  bool up() const { return state_ == LINK_UP; }
+  // True when the connection just made should refresh the fast-reconnect cache
+  bool lastConnectWasScan() const { return !attemptFast_; }
+  uint32_t lastAssociateMs() const { return lastAssociateMs_; }
+  // Wait before the next scan, set when an attempt is aborted
+  uint32_t retryDelayMs() const { return retryDelayMs_; }
+  const LinkStats &stats() const { return stats_; }
+
+  // Share of the tracked time the link was up, in parts per thousand
+  uint32_t upPermille() const {
+    return stats_.trackedMs ? (uint32_t)(stats_.upMs * 1000 / stats_.trackedMs) : 0;
+  }
+
+ private:
+  LinkAction startAttempt(uint32_t nowMs, bool haveCache) {
+    state_ = LINK_CONNECTING;
+    attemptStartMs_ = nowMs;
+    attemptFast_ = haveCache;
+    if (attemptFast_) {
+      stats_.fastAttempts++;
+      return LINK_ACTION_CONNECT_FAST;
+    }
+    stats_.scanAttempts++;
+    return LINK_ACTION_CONNECT_SCAN;
+  }
+
+  LinkAction connectedAt(uint32_t nowMs) {
+    // Connected outside an attempt (e.g. the previous attempt completing
+    // late during backoff) counts as a scan connection
+    if (state_ != LINK_CONNECTING) attemptFast_ = false;
+    lastAssociateMs_ = nowMs - attemptStartMs_;
+    if (attemptFast_) {
+      stats_.fastConnects++;
+      stats_.fastAssociateMs += lastAssociateMs_;
+    } else {
+      stats_.scanConnects++;
+      stats_.scanAssociateMs += lastAssociateMs_;
+    }
+    if (hadLink_) {
+      const uint32_t outage = nowMs - outageStartMs_;
+      stats_.reconnects++;
+      stats_.lastOutageMs = outage;
+      stats_.totalOutageMs += outage;
+      if (outage > stats_.maxOutageMs) stats_.maxOutageMs = outage;
+    }
+    state_ = LINK_UP;
+    backoffMs_ = backoffMinMs_;
+    return LINK_ACTION_NONE;
+  }
+
+  // Up to 25% either way, so vehicles leaving the same dead zone spread out
+  uint32_t jittered(uint32_t ms) {
+    random_ ^= random_ << 13;
+    random_ ^= random_ >> 17;
+    random_ ^= random_ << 5;
+    const uint32_t span = ms / 2;
+    return span ? ms - span / 2 + random_ % span : ms;
+  }
+
+  const uint32_t fastTimeoutMs_;
+  const uint32_t scanTimeoutMs_;
+  const uint32_t backoffMinMs_;
+  const uint32_t backoffMaxMs_;
+
+  LinkState state_ = LINK_DOWN;
+  bool started_ = false;
+  bool hadLink_ = false;       // Boot connection is not a reconnect
+  bool attemptFast_ = false;
+  uint32_t attemptStartMs_ = 0;
+  uint32_t outageStartMs_ = 0;
+  uint32_t backoffUntilMs_ = 0;
+  uint32_t backoffMs_;
+  uint32_t retryDelayMs_ = 0;
+  uint32_t lastUpdateMs_ = 0;
+  uint32_t lastAssociateMs_ = 0;
+  uint32_t random_ = 1;
+  LinkStats stats_ = {};
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "fast_math.h"
+
+// Madgwick gradient-descent orientation filter, IMU (accel + gyro) variant.
+// Gyro integration tracks fast rotation, the accelerometer pulls the estimate
+// back toward gravity at a rate set by beta. Roll/pitch use the same axis
+// convention as the old single-sample atan2 estimate.
+class OrientationFilter {
+ public:
+  explicit OrientationFilter(float beta = 0.1f) : beta_(beta) {}
+
+  // Seed the quaternion from one accelerometer sample so the filter does not
+  // have to converge from level at startup
+  void reset(float ax, float ay, float az) {
+    const float roll = fastmath::atan2(ay, az);
+    const float pitch = fastmath::atan2(-ax, fastmath::sqrt(ay * ay + az * az));
+    const float cr = cosHalf(roll), sr = sinHalf(roll);
+    const float cp = cosHalf(pitch), sp = sinHalf(pitch);
+    q0_ = cr * cp;
+    q1_ = sr * cp;
+    q2_ = cr * sp;
+    q3_ = -sr * sp;
+    initialized_ = true;
+  }
+
+  // Accelerometer in any unit (m/s^2 from the Adafruit driver), gyro in rad/s, dt in seconds
+  void update(float ax, float ay, float az, float gx, float gy, float gz, float dt) {
+    if (!initialized_) {
+      reset(ax, ay, az);
+      return;
+    }
+
+    float q0 = q0_, q1 = q1_, q2 = q2_, q3 = q3_;
+
+    // Rate of change of quaternion from gyroscope
+    float qDot1 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qDot2 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qDot3 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qDot4 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    // Accelerometer correction, skipped in free fall
+    const float aNormSq = ax * ax + ay * ay + az * az;
+    if (aNormSq > 0.0f) {
+      const float recipNorm = fastmath::invSqrt(aNormSq);
+      ax *= recipNorm;
+      ay *= recipNorm;
+      az *= recipNorm;
+
+      const float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+      const float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+      const float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+      const float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+      // Gradient descent corrective step
+      float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+      float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+      float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+      float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+      const float sNormSq = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+      if (sNormSq > 0.0f) {
+        const float recipS = fastmath::invSqrt(sNormSq);
+        qDot1 -= beta_ * s0 * recipS;
+        qDot2 -= beta_ * s1 * recipS;
+        qDot3 -= beta_ * s2 * recipS;
+        qDot4 -= beta_ * s3 * recipS;
+      }
+    }
+
+    q0 += qDot1 * dt;
+    q1 += qDot2 * dt;
+    q2 += qDot3 * dt;
+    q3 += qDot4 * dt;
+
+    const float recipQ = fastmath::invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q0_ = q0 * recipQ;
+    q1_ = q1 * recipQ;
+    q2_ = q2 * recipQ;
+    q3_ = q3 * recipQ;
+  }
+
+  float rollDeg() const {
+    return fastmath::atan2(q0_ * q1_ + q2_ * q3_, 0.5f - q1_ * q1_ - q2_ * q2_) * fastmath::kRadToDeg;
+  }
+
+  float pitchDeg() const {
+    return fastmath::asin(-2.0f * (q1_ * q3_ - q0_ * q2_)) * fastmath::kRadToDeg;
+  }
+
+  bool initialized() const { return initialized_; }
+
+ private:
+  // cos/sin of half an angle in (-pi, pi], only used once per reset
+  static float cosHalf(float angle) { return fastmath::sqrt(0.5f * (1.0f + cosApprox(angle))); }
+  static float sinHalf(float angle) {
+    const float s = fastmath::sqrt(0.5f * (1.0f - cosApprox(angle)));
+    return angle < 0.0f ? -s : s;
+  }
+  static float cosApprox(float angle) {
+    // Taylor series on [0, pi/2] is accurate enough for seeding
+    float x = angle < 0.0f ? -angle : angle;
+    const bool flip = x > fastmath::kHalfPi;
+    if (flip) x = fastmath::kPi - x;
+    const float x2 = x * x;
+    const float c = 1.0f - x2 * (0.5f - x2 * (1.0f / 24.0f - x2 / 720.0f));
+    return flip ? -c : c;
+  }
+
+  float beta_;
+  float q0_ = 1.0f, q1_ = 0.0f, q2_ = 0.0f, q3_ = 0.0f;
+  bool initialized_ = false;
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+// Compile-time pin, task and control-loop schedule checks.
+//
+// PinUse tables are validated against a BoardConfig: no pin used twice, no
+// reserved pins, no outputs on input-only pins, analog inputs on ADC1.
+// TaskBudget tables are checked for CPU over-subscription per core.
+//
+// StaticSchedule runs periodic jobs from the control loop. Each job is a
+// function with a period and phase in milliseconds; the schedule expands to
+// one `tick % period == phase` test with constant operands and a direct call
+// per job, with no tables or lookups at run time. Its worst tick (the most
+// job budget due in one control period) is computed at compile time. The
+// budgets themselves are only declared here: a job is held to its budget at
+// run time by a DeadlineMonitor stage registered with jobBudgetUs<Fn>().
+
+enum PinMode : uint8_t {
+  PIN_DIGITAL_IN,
+  PIN_DIGITAL_OUT,
+  PIN_ANALOG_IN,
+  PIN_BUS            // I2C/UART lines, driven both ways
+};
+
+struct PinUse {
+  uint8_t pin;
+  PinMode mode;
+  const char *name;
+};
+
+struct TaskBudget {
+  const char *name;
+  uint32_t periodUs;
+  uint32_t budgetUs;   // CPU time per period, not counting blocked time
+  uint8_t core;
+};
+
+template <size_t N>
+constexpr bool pins_unique(const PinUse (&pins)[N]) {
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = i + 1; j < N; j++) {
+      if (pins[i].pin == pins[j].pin) return false;
+    }
+  }
+  return true;
+}
+
+template <typename BoardT, size_t N>
+constexpr bool pins_exist(const PinUse (&pins)[N]) {
+  for (size_t i = 0; i < N; i++) {
+    if (pins[i].pin >= BoardT::pinCount || (BoardT::reservedPins & (1ull << pins[i].pin))) return false;
+  }
+  return true;
+}
+
+template <typename BoardT, size_t N>
+constexpr bool pins_can_drive(const PinUse (&pins)[N]) {
+  for (size_t i = 0; i < N; i++) {
+    const bool drives = pins[i].mode == PIN_DIGITAL_OUT || pins[i].mode == PIN_BUS;
+    if (drives && (BoardT::inputOnlyPins & (1ull << pins[i].pin))) return false;
+  }
+  return true;
+}
+
+template <typename BoardT, size_t N>
+constexpr bool pins_analog_capable(const PinUse (&pins)[N]) {
+  for (size_t i = 0; i < N; i++) {
+    if (pins[i].mode == PIN_ANALOG_IN && !(BoardT::adcPins & (1ull << pins[i].pin))) return false;
+  }
+  return true;
+}
+
+// Sum of budget/period on one core, in parts per thousand
+template <size_t N>
+constexpr uint32_t core_load_permille(const TaskBudget (&tasks)[N], uint8_t core) {
+  uint64_t load = 0;
+  for (size_t i = 0; i < N; i++) {
+    if (tasks[i].core == core) load += (uint64_t)tasks[i].budgetUs * 1000 / tasks[i].periodUs;
+  }
+  return (uint32_t)load;
+}
+
+template <void (*Fn)(), uint32_t PeriodMs, uint32_t PhaseMs = 0, uint32_t BudgetUs = 0>
+struct PeriodicJob {
+  static_assert(PeriodMs > 0, "Job period must be positive");
+  static_assert(PhaseMs < PeriodMs, "Job phase must be inside its period");
+
+  static constexpr uint32_t periodMs = PeriodMs;
+  static constexpr uint32_t phaseMs = PhaseMs;
+  static constexpr uint32_t budgetUs = BudgetUs;
+  static constexpr void (*function)() = Fn;
+
+  // `tick` counts periods of TickMs since start
+  template <uint32_t TickMs>
+  static constexpr bool due(uint32_t tick) { return tick % (PeriodMs / TickMs) == PhaseMs / TickMs; }
+  static void run() { Fn(); }
+};
+
+constexpr uint32_t schedule_gcd(uint32_t a, uint32_t b) { return b == 0 ? a : schedule_gcd(b, a % b); }
+constexpr uint32_t schedule_lcm(uint32_t a, uint32_t b) { return a / schedule_gcd(a, b) * b; }
+
+constexpr bool schedule_all(std::initializer_list<bool> values) {
+  for (bool v : values) {
+    if (!v) return false;
+  }
+  return true;
+}
+
+template <uint32_t TickMs, typename... Jobs>
+class StaticSchedule {
+  static_assert(TickMs > 0, "Tick must be positive");
+  static_assert(sizeof...(Jobs) > 0, "Empty schedule");
+  static_assert(schedule_all({(Jobs::periodMs % TickMs == 0 && Jobs::phaseMs % TickMs == 0)...}),
+                "Job periods and phases must be multiples of the tick");
+
+ public:
+  static constexpr size_t jobCount = sizeof...(Jobs);
+
+  // Every pattern of due jobs repeats after this many milliseconds
+  static constexpr uint32_t hyperperiodMs() {
+    uint32_t lcm = TickMs;
+    for (uint32_t period : {Jobs::periodMs...}) lcm = schedule_lcm(lcm, period);
+    return lcm;
+  }
+
+  // Largest total job budget due in any single tick
+  static constexpr uint32_t worstTickBudgetUs() {
+    const uint32_t budget[] = {Jobs::budgetUs...};
+    uint32_t worst = 0;
+    for (uint32_t tick = 0; tick < hyperperiodMs() / TickMs; tick++) {
+      const bool due[] = {Jobs::template due<TickMs>(tick)...};
+      uint32_t total = 0;
+      for (size_t i = 0; i < jobCount; i++) {
+        if (due[i]) total += budget[i];
+      }
+      if (total > worst) worst = total;
+    }
+    return worst;
+  }
+
+  // Declared budget of the job that runs Fn, 0 when Fn is not scheduled
+  template <void (*Fn)()>
+  static constexpr uint32_t jobBudgetUs() {
+    return ((Jobs::function == Fn ? Jobs::budgetUs : 0) + ...);
+  }
+
+  // Mean job budget per tick
+  static constexpr uint32_t averageTickBudgetUs() {
+    const uint32_t budget[] = {Jobs::budgetUs...};
+    const uint32_t period[] = {Jobs::periodMs...};
+    uint64_t total = 0;
+    for (size_t i = 0; i < jobCount; i++) {
+      total += (uint64_t)budget[i] * TickMs / period[i];
+    }
+    return (uint32_t)total;
+  }
+
+  // Runs the jobs due at `tick` (control periods since start), in declaration order
+  static void run(uint32_t tick) {
+    ((Jobs::template due<TickMs>(tick) ? Jobs::run() : void()), ...);
+  }
+};
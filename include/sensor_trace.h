@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Binary raw-sensor trace format shared by the firmware recorder and
+// tools/trace_replay.cpp.
+//
+// A trace is a byte stream of self-delimiting frames, so it can be stored in
+// a file or interleaved with text on the debug serial port:
+//
+//   0xA5 0x5A | length (u8) | type (u8) | channel (u8) | time_us (u32 LE) | payload | crc16 (LE)
+//
+// length counts type..payload. crc16 (CCITT, poly 0x1021) covers length..payload.
+// Readers resynchronise on the sync bytes and drop frames with a bad CRC.
+
+#define TRACE_SYNC_0 0xA5
+#define TRACE_SYNC_1 0x5A
+#define TRACE_HEADER_BYTES 6     // type, channel, time_us
+#define TRACE_MAX_PAYLOAD 64
+#define TRACE_MAX_FRAME (3 + TRACE_HEADER_BYTES + TRACE_MAX_PAYLOAD + 2)
+
+enum TraceType : uint8_t {
+  TRACE_BOOT = 0,        // Payload: u32 format version
+  TRACE_ULTRASONIC = 1,  // Payload: TraceUltrasonic, channel = sensor index
+  TRACE_IMU = 2,         // Payload: TraceImu
+  TRACE_ADC = 3,         // Payload: u16 raw value, channel = TraceAdcChannel
+  TRACE_ADC_BLOCK = 4,   // Payload: u16 sample period (us) + u16 samples, evenly spaced ending at time_us
+  TRACE_NMEA = 5,        // Payload: raw GPS UART bytes
+};
+
+enum TraceAdcChannel : uint8_t {
+  TRACE_ADC_VIBRATION = 0,
+  TRACE_ADC_ALCOHOL = 1,
+  TRACE_ADC_PULSE = 2,
+  TRACE_ADC_HALL = 3,
+};
+
+#define TRACE_FORMAT_VERSION 1
+#define TRACE_ADC_BLOCK_SAMPLES ((TRACE_MAX_PAYLOAD - 2) / 2)
+
+struct TraceUltrasonic {
+  int32_t distanceCm;
+};
+
+struct TraceImu {
+  float ax, ay, az;  // m/s^2
+  float gx, gy, gz;  // rad/s
+  float tempC;
+};
+
+struct TraceRecord {
+  uint32_t timeUs;
+  uint8_t type;
+  uint8_t channel;
+  uint8_t length;
+  uint8_t payload[TRACE_MAX_PAYLOAD];
+};
+
+inline uint16_t trace_crc16(const uint8_t *data, size_t length) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+inline bool trace_make_record(TraceRecord &record, uint32_t timeUs, uint8_t type, uint8_t channel,
+                              const void *payload, size_t length) {
+  if (length > TRACE_MAX_PAYLOAD) return false;
+  record.timeUs = timeUs;
+  record.type = type;
+  record.channel = channel;
+  record.length = (uint8_t)length;
+  memcpy(record.payload, payload, length);
+  return true;
+}
+
+// Encodes one record; out must hold TRACE_MAX_FRAME bytes. Returns the frame size.
+inline size_t trace_encode_frame(const TraceRecord &record, uint8_t *out) {
+  out[0] = TRACE_SYNC_0;
+  out[1] = TRACE_SYNC_1;
+  out[2] = (uint8_t)(TRACE_HEADER_BYTES + record.length);
+  out[3] = record.type;
+  out[4] = record.channel;
+  out[5] = (uint8_t)(record.timeUs);
+  out[6] = (uint8_t)(record.timeUs >> 8);
+  out[7] = (uint8_t)(record.timeUs >> 16);
+  out[8] = (uint8_t)(record.timeUs >> 24);
+  memcpy(out + 9, record.payload, record.length);
+  const size_t body = 9 + record.length;
+  const uint16_t crc = trace_crc16(out + 2, body - 2);
+  out[body] = (uint8_t)crc;
+  out[body + 1] = (uint8_t)(crc >> 8);
+  return body + 2;
+}
+
+// Streaming frame decoder. Feed bytes one at a time; returns true when
+// `record` holds a complete, CRC-checked frame.
+class TraceParser {
+ public:
+  bool feed(uint8_t byte, TraceRecord &record) {
+    switch (state_) {
+      case WAIT_SYNC0:
+        if (byte == TRACE_SYNC_0) state_ = WAIT_SYNC1;
+        else skippedBytes_++;
+        return false;
+      case WAIT_SYNC1:
+        if (byte == TRACE_SYNC_1) {
+          state_ = WAIT_LENGTH;
+        } else {
+          skippedBytes_++;
+          state_ = byte == TRACE_SYNC_0 ? WAIT_SYNC1 : WAIT_SYNC0;
+        }
+        return false;
+      case WAIT_LENGTH:
+        if (byte < TRACE_HEADER_BYTES || byte > TRACE_HEADER_BYTES + TRACE_MAX_PAYLOAD) {
+          badFrames_++;
+          state_ = WAIT_SYNC0;
+          return false;
+        }
+        frame_[0] = byte;
+        expected_ = byte;
+        received_ = 0;
+        state_ = READ_BODY;
+        return false;
+      case READ_BODY:
+        frame_[1 + received_++] = byte;
+        if (received_ < expected_) return false;
+        state_ = READ_CRC_LOW;
+        return false;
+      case READ_CRC_LOW:
+        crcLow_ = byte;
+        state_ = READ_CRC_HIGH;
+        return false;
+      case READ_CRC_HIGH:
+        state_ = WAIT_SYNC0;
+        if (trace_crc16(frame_, 1 + expected_) != (uint16_t)(crcLow_ | (byte << 8))) {
+          badFrames_++;
+          return false;
+        }
+        record.type = frame_[1];
+        record.channel = frame_[2];
+        record.timeUs = (uint32_t)frame_[3] | ((uint32_t)frame_[4] << 8) |
+                        ((uint32_t)frame_[5] << 16) | ((uint32_t)frame_[6] << 24);
+        record.length = (uint8_t)(expected_ - TRACE_HEADER_BYTES);
+        memcpy(record.payload, frame_ + 7, record.length);
+        return true;
+    }
+    return false;
+  }
+
+  uint32_t badFrames() const { return badFrames_; }
+  uint32_t skippedBytes() const { return skippedBytes_; }
+
+ private:
+  enum State { WAIT_SYNC0, WAIT_SYNC1, WAIT_LENGTH, READ_BODY, READ_CRC_LOW, READ_CRC_HIGH };
+  State state_ = WAIT_SYNC0;
+  uint8_t frame_[1 + TRACE_HEADER_BYTES + TRACE_MAX_PAYLOAD];
+  uint8_t expected_ = 0;
+  uint8_t received_ = 0;
+  uint8_t crcLow_ = 0;
+  uint32_t badFrames_ = 0;
+  uint32_t skippedBytes_ = 0;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer sequence lock. The writer never blocks; tryRead() copies the
+// value and fails if a write was in progress or overlapped the copy, so a
+// reader never sees a torn, mixed-epoch value and never waits. The payload is
+// stored as 32-bit atomic words so the concurrent copy is race-free on both
+// the ESP32 and the host.
+//
+// There is deliberately no blocking read. A reader that preempts the writer
+// mid-write on the writer's core would retry forever, since the writer cannot
+// run again until the reader yields. Rule: only a reader on another core than
+// the writer, or at no higher priority than the writer, may retry tryRead();
+// any other reader keeps its last good copy when tryRead() fails.
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+  static constexpr size_t kWords = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+ public:
+  SeqLock() {
+    for (size_t i = 0; i < kWords; i++) words_[i].store(0, std::memory_order_relaxed);
+  }
+
+  // Only ever call from one task
+  void write(const T &value) {
+    uint32_t words[kWords] = {};
+    memcpy(words, &value, sizeof(T));
+
+    const uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);  // Odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  // One bounded attempt; false if a write was in progress or overlapped, and
+  // `out` is left untouched
+  bool tryRead(T &out) const {
+    const uint32_t before = seq_.load(std::memory_order_acquire);
+    if (before & 1) return false;
+
+    uint32_t words[kWords];
+    for (size_t i = 0; i < kWords; i++) {
+      words[i] = words_[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq_.load(std::memory_order_relaxed) != before) return false;
+
+    memcpy(&out, words, sizeof(T));
+    return true;
+  }
+
+  // Even values count completed writes
+  uint32_t sequence() const { return seq_.load(std::memory_order_acquire); }
+
+ private:
+  std::atomic<uint32_t> seq_{0};
+  std::atomic<uint32_t> words_[kWords];
+};
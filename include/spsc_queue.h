@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free ring queue for exactly one producer task and one consumer task.
+// Used to hand data between the control core and the network core without
+// either side ever blocking. push() fails (and counts a drop) when full.
+template <typename T, size_t Capacity>
+class SpscQueue {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "SpscQueue capacity must be a power of two");
+
+ public:
+  bool push(const T &item) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t tail = tail_.load(std::memory_order_acquire);
+    if (head - tail >= Capacity) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    buffer_[head & (Capacity - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+
+    // Only the producer writes the high-water mark, so a plain compare is enough
+    const uint32_t depth = head + 1 - tail;
+    if (depth > highWater_.load(std::memory_order_relaxed)) {
+      highWater_.store(depth, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  bool pop(T &item) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    if (head == tail) {
+      return false;
+    }
+    item = buffer_[tail & (Capacity - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Tail first: it never passes head, so a head loaded after it gives a
+  // possibly stale but never negative (wrapped) depth
+  size_t size() const {
+    const uint32_t tail = tail_.load(std::memory_order_acquire);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    return head - tail;
+  }
+
+  bool empty() const { return size() == 0; }
+  static constexpr size_t capacity() { return Capacity; }
+  uint32_t highWater() const { return highWater_.load(std::memory_order_relaxed); }
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  T buffer_[Capacity];
+  std::atomic<uint32_t> head_{0};  // Written by the producer only
+  std::atomic<uint32_t> tail_{0};  // Written by the consumer only
+  std::atomic<uint32_t> highWater_{0};
+  std::atomic<uint32_t> dropped_{0};
+};
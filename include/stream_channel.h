@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Flow control for the real-time stream to the dashboard. The link may be
+// slower than the sample rate: only the newest frame is kept pending, at most
+// Window frames are unacknowledged, and older pending frames are coalesced
+// (overwritten) instead of queueing up behind a slow link.
+
+template <typename Frame, size_t Window>
+class CoalescingSender {
+  static_assert(Window >= 1 && Window <= 16, "CoalescingSender window must be 1..16");
+
+ public:
+  // Producer side: newest frame replaces any frame not yet sent
+  void offer(const Frame &frame, uint32_t captureUs) {
+    if (hasPending_) coalesced_++;
+    pending_ = frame;
+    pendingCaptureUs_ = captureUs;
+    hasPending_ = true;
+  }
+
+  bool ready() const { return hasPending_ && inFlight_ < Window; }
+
+  // Takes the pending frame for sending and assigns its sequence number
+  bool take(Frame &frame, uint32_t &seq, uint32_t nowUs) {
+    if (!ready()) {
+      if (hasPending_) blocked_++;
+      return false;
+    }
+    for (size_t i = 0; i < Window; i++) {
+      if (!slots_[i].used) {
+        seq = nextSeq_++;
+        slots_[i] = {true, seq, nowUs, pendingCaptureUs_};
+        inFlight_++;
+        break;
+      }
+    }
+    frame = pending_;
+    hasPending_ = false;
+    sent_++;
+    return true;
+  }
+
+  // Matches an acknowledgement; returns false for unknown or expired sequence numbers
+  bool ack(uint32_t seq, uint32_t nowUs, uint32_t &sendToAckUs, uint32_t &captureToAckUs) {
+    for (size_t i = 0; i < Window; i++) {
+      if (slots_[i].used && slots_[i].seq == seq) {
+        sendToAckUs = nowUs - slots_[i].sentUs;
+        captureToAckUs = nowUs - slots_[i].captureUs;
+        slots_[i].used = false;
+        inFlight_--;
+        acked_++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Frees window slots whose ack never arrived so a lost ack cannot stall the stream
+  void expire(uint32_t nowUs, uint32_t timeoutUs) {
+    for (size_t i = 0; i < Window; i++) {
+      if (slots_[i].used && nowUs - slots_[i].sentUs > timeoutUs) {
+        slots_[i].used = false;
+        inFlight_--;
+        lost_++;
+      }
+    }
+  }
+
+  // Connection dropped: in-flight frames will never be acknowledged
+  void reset() {
+    for (size_t i = 0; i < Window; i++) slots_[i].used = false;
+    inFlight_ = 0;
+  }
+
+  size_t inFlight() const { return inFlight_; }
+  uint32_t sent() const { return sent_; }
+  uint32_t acked() const { return acked_; }
+  uint32_t coalesced() const { return coalesced_; }
+  uint32_t blocked() const { return blocked_; }
+  uint32_t lost() const { return lost_; }
+
+ private:
+  struct Slot {
+    bool used;
+    uint32_t seq;
+    uint32_t sentUs;
+    uint32_t captureUs;
+  };
+
+  Frame pending_{};
+  uint32_t pendingCaptureUs_ = 0;
+  bool hasPending_ = false;
+  Slot slots_[Window] = {};
+  size_t inFlight_ = 0;
+  uint32_t nextSeq_ = 1;
+  uint32_t sent_ = 0, acked_ = 0, coalesced_ = 0, blocked_ = 0, lost_ = 0;
+};
+
+// Last N latency samples with percentiles computed on demand
+template <size_t N>
+class LatencyWindow {
+ public:
+  void record(uint32_t us) {
+    samples_[next_] = us;
+    next_ = (next_ + 1) % N;
+    if (count_ < N) count_++;
+  }
+
+  size_t count() const { return count_; }
+
+  // p in [0, 100]; 0 when empty
+  uint32_t percentile(unsigned p) const {
+    if (count_ == 0) return 0;
+    uint32_t sorted[N];
+    std::copy(samples_, samples_ + count_, sorted);
+    std::sort(sorted, sorted + count_);
+    size_t index = (count_ - 1) * p / 100;
+    return sorted[index];
+  }
+
+ private:
+  uint32_t samples_[N] = {};
+  size_t next_ = 0;
+  size_t count_ = 0;
+};
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "alert_orchestrator.h"
+#include "link_manager.h"
+
+// The periodic telemetry POST to the backend (/api/sensor), written straight
+// into a caller-supplied buffer. send_to_backend() and tools/load_gen.cpp
+// both build their requests with write_telemetry_payload(), so a load test
+// sends byte-for-byte the documents a fleet would.
+
+#define HISTORY_SIZE 20             // Store last 20 readings for each sensor
+#define PULSE_DATA_POINTS 60        // Store 1 minute of data
+#define TELEMETRY_PAYLOAD_MAX 6144  // Full histories come to about 4 KB
+
+struct SensorHistory {
+    long distance[HISTORY_SIZE];
+    int alcohol[HISTORY_SIZE];
+    float impact[HISTORY_SIZE];
+    int pulse[HISTORY_SIZE];
+    int vibration[HISTORY_SIZE];
+    int index;
+};
+
+struct PulseData {
+    unsigned long timestamp;
+    int value;
+};
+
+// Latency of the last finished alert, reported with the periodic telemetry
+struct AlertReport {
+  uint32_t count;
+  int32_t level;
+  int32_t dispatchMs;
+  int32_t firstMs;                           // Detection to the first delivered notification
+  int32_t channelMs[ALERT_MAX_CHANNELS];     // Detection to delivery, -1 if not delivered
+};
+
+// Everything one POST reports. Pointers are borrowed for the call.
+struct TelemetryPayload {
+  const char *deviceId;
+  const char *timestamp;        // Decimal milliseconds, UTC once the clock is synced
+  const char *timeSource;
+  bool clockValid;
+  int64_t utcUs;                // Capture time of the readings
+  int64_t sentUtcUs;
+  uint32_t clockUncertaintyUs;
+
+  int alcohol;
+  const char *alcoholState;
+  int vibration;
+  float vibrationRms;
+  uint8_t roadCondition;
+  const float *vibrationBands;
+  size_t vibrationBandCount;
+  long distance;
+  bool seatbelt;
+  float impact;
+  int pulse;
+  float roll;
+  float pitch;
+  float speed;
+  const char *lcdDisplay;
+
+  bool gpsValid;
+  float lat;
+  float lng;
+  uint32_t satellites;
+
+  const AlertReport *alert;     // Null until the first alert finished
+  size_t smsChannels;           // alert->channelMs: SMS channels, then call, then backend
+
+  const LinkStats *link;
+  float linkUptimePct;
+  int rssi;
+
+  int pulseMin;
+  int pulseMax;
+  const PulseData *pulseData;   // Ring of PULSE_DATA_POINTS, newest before pulseDataIndex
+  int pulseDataIndex;
+  const SensorHistory *history;
+};
+
+// Minimal JSON writer: appends to a fixed buffer, commas handled by nesting
+// level. Once the buffer is full everything else is dropped and overflowed()
+// is set, so the caller checks once at the end.
+class JsonWriter {
+ public:
+  JsonWriter(char *buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {
+    if (capacity_) buffer_[0] = '\0';
+  }
+
+  void beginObject(const char *key = nullptr) { open(key, '{'); }
+  void endObject() { close('}'); }
+  void beginArray(const char *key = nullptr) { open(key, '['); }
+  void endArray() { close(']'); }
+
+  void intField(const char *key, int64_t value) {
+    this->key(key);
+    append("%lld", (long long)value);
+  }
+
+  // Floats print with 7 significant digits; NaN and infinity as null
+  void floatField(const char *key, double value) {
+    this->key(key);
+    if (std::isfinite(value)) append("%.7g", value);
+    else append("null");
+  }
+
+  void boolField(const char *key, bool value) {
+    this->key(key);
+    append(value ? "true" : "false");
+  }
+
+  void stringField(const char *key, const char *value) {
+    this->key(key);
+    put('"');
+    for (const char *c = value ? value : ""; *c; c++) {
+      const unsigned char ch = (unsigned char)*c;
+      if (ch == '"' || ch == '\\') {
+        put('\\');
+        put(*c);
+      } else if (ch == '\n') {
+        put('\\');
+        put('n');
+      } else if (ch < 0x20) {
+        append("\\u%04x", ch);
+      } else {
+        put(*c);
+      }
+    }
+    put('"');
+  }
+
+  // Array elements
+  void intValue(int64_t value) { intField(nullptr, value); }
+  void floatValue(double value) { floatField(nullptr, value); }
+
+  const char *data() const { return buffer_; }
+  size_t length() const { return length_; }
+  bool overflowed() const { return overflowed_; }
+
+ private:
+  void key(const char *name) {
+    if (depth_ > 0) {
+      if (!first_[depth_ - 1]) put(',');
+      first_[depth_ - 1] = false;
+    }
+    if (name) {
+      put('"');
+      append("%s", name);
+      put('"');
+      put(':');
+    }
+  }
+
+  void open(const char *name, char bracket) {
+    key(name);
+    put(bracket);
+    if (depth_ < sizeof(first_)) first_[depth_++] = true;
+    else overflowed_ = true;
+  }
+
+  void close(char bracket) {
+    if (depth_ > 0) depth_--;
+    put(bracket);
+  }
+
+  void put(char c) {
+    if (length_ + 1 >= capacity_) {
+      overflowed_ = true;
+      return;
+    }
+    buffer_[length_++] = c;
+    buffer_[length_] = '\0';
+  }
+
+  template <typename... Args>
+  void append(const char *format, Args... args) {
+    if (overflowed_ || length_ >= capacity_) {
+      overflowed_ = true;
+      return;
+    }
+    const int n = snprintf(buffer_ + length_, capacity_ - length_, format, args...);
+    if (n < 0 || (size_t)n >= capacity_ - length_) {
+      overflowed_ = true;
+      buffer_[length_] = '\0';
+      return;
+    }
+    length_ += (size_t)n;
+  }
+
+  char *buffer_;
+  size_t capacity_;
+  size_t length_ = 0;
+  bool first_[8] = {};
+  uint8_t depth_ = 0;
+  bool overflowed_ = false;
+};
+
+// Length of the document, or 0 if it did not fit in `capacity`
+inline size_t write_telemetry_payload(const TelemetryPayload &p, char *buffer, size_t capacity) {
+  JsonWriter json(buffer, capacity);
+  json.beginObject();
+  json.stringField("device_id", p.deviceId);
+  json.stringField("timestamp", p.timestamp);
+  json.stringField("time_source", p.timeSource);
+  if (p.clockValid) {
+    json.intField("utc_us", p.utcUs);
+    json.intField("sent_utc_us", p.sentUtcUs);
+    json.intField("clock_uncertainty_us", p.clockUncertaintyUs);
+  }
+  json.intField("alcohol", p.alcohol);
+  json.stringField("alcohol_state", p.alcoholState);
+  json.intField("vibration", p.vibration);
+  json.floatField("vibration_rms", p.vibrationRms);
+  json.intField("road_condition", p.roadCondition);
+  json.intField("distance", p.distance);
+  json.boolField("seatbelt", p.seatbelt);
+  json.floatField("impact", p.impact);
+  json.intField("pulse", p.pulse);
+  json.floatField("roll", p.roll);
+  json.floatField("pitch", p.pitch);
+  json.floatField("speed", p.speed);
+  json.stringField("lcd_display", p.lcdDisplay);
+
+  // Always include GPS coordinates, even if they're 0
+  if (p.gpsValid) {
+    json.floatField("lat", p.lat);
+    json.floatField("lng", p.lng);
+    json.boolField("gps_valid", true);
+    json.intField("satellites", p.satellites);
+  } else {
+    json.boolField("gps_valid", false);
+  }
+
+  // Detection-to-notification latency of the last alert, per channel (-1 = not delivered)
+  if (p.alert && p.alert->count > 0) {
+    json.beginObject("last_alert");
+    json.intField("level", p.alert->level);
+    json.intField("dispatch_ms", p.alert->dispatchMs);
+    json.intField("first_notification_ms", p.alert->firstMs);
+    json.beginArray("sms_ms");
+    for (size_t i = 0; i < p.smsChannels; i++) json.intValue(p.alert->channelMs[i]);
+    json.endArray();
+    json.intField("call_ms", p.alert->channelMs[p.smsChannels]);
+    json.intField("backend_ms", p.alert->channelMs[p.smsChannels + 1]);
+    json.endObject();
+  }
+
+  // Link quality through the dead zones since boot
+  if (p.link) {
+    json.beginObject("wifi");
+    json.floatField("uptime_pct", p.linkUptimePct);
+    json.intField("drops", p.link->drops);
+    json.intField("reconnects", p.link->reconnects);
+    json.intField("last_reconnect_ms", p.link->lastOutageMs);
+    json.intField("max_reconnect_ms", p.link->maxOutageMs);
+    json.intField("rssi", p.rssi);
+    json.endObject();
+  }
+
+  json.beginArray("vibration_bands");
+  for (size_t b = 0; b < p.vibrationBandCount; b++) json.floatValue(p.vibrationBands[b]);
+  json.endArray();
+
+  // Current pulse reading separately for real-time display
+  json.intField("current_pulse", p.pulse);
+  json.intField("pulse_threshold_min", p.pulseMin);
+  json.intField("pulse_threshold_max", p.pulseMax);
+
+  // Pulse history with timestamps, newest first
+  json.beginArray("pulse_data");
+  for (int i = 0; i < PULSE_DATA_POINTS; i++) {
+    const PulseData &reading = p.pulseData[(p.pulseDataIndex - 1 - i + PULSE_DATA_POINTS) % PULSE_DATA_POINTS];
+    if (reading.timestamp > 0) {  // Only send valid readings
+      json.beginObject();
+      json.intField("timestamp", (int64_t)reading.timestamp);
+      json.intField("value", reading.value);
+      json.endObject();
+    }
+  }
+  json.endArray();
+
+  // Sensor histories, oldest first
+  const SensorHistory &h = *p.history;
+  json.beginArray("pulse_history");
+  for (int i = HISTORY_SIZE - 1; i >= 0; i--) json.intValue(h.pulse[(h.index - i + HISTORY_SIZE) % HISTORY_SIZE]);
+  json.endArray();
+  json.beginArray("distance_history");
+  for (int i = HISTORY_SIZE - 1; i >= 0; i--) json.intValue(h.distance[(h.index - i + HISTORY_SIZE) % HISTORY_SIZE]);
+  json.endArray();
+  json.beginArray("alcohol_history");
+  for (int i = HISTORY_SIZE - 1; i >= 0; i--) json.intValue(h.alcohol[(h.index - i + HISTORY_SIZE) % HISTORY_SIZE]);
+  json.endArray();
+  json.beginArray("impact_history");
+  for (int i = HISTORY_SIZE - 1; i >= 0; i--) json.floatValue(h.impact[(h.index - i + HISTORY_SIZE) % HISTORY_SIZE]);
+  json.endArray();
+  json.beginArray("vibration_history");
+  for (int i = HISTORY_SIZE - 1; i >= 0; i--) json.intValue(h.vibration[(h.index - i + HISTORY_SIZE) % HISTORY_SIZE]);
+  json.endArray();
+
+  json.endObject();
+  return json.overflowed() ? 0 : json.length();
+}
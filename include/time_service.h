@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Maps the free-running monotonic microsecond clock (esp_timer) to UTC.
+//
+// References come from GPS and SNTP as (monotonic, UTC) pairs. Each one is an
+// offset UTC - monotonic at some monotonic time. A least-squares line through
+// the last CLOCK_FIT_POINTS offsets gives the clock's offset and drift, so
+// the model stays accurate between references and through reference gaps.
+//
+// GPS: an NMEA sentence reports the UTC second of its fix, but it arrives a
+// variable 20-500 ms later. The arrival time of the sentence's '$' is
+// stamped, and since the delay is never negative, the largest offset seen in
+// a window of sentences belongs to the least delayed one. Only that one
+// becomes a reference. A fixed per-module delay that the filter cannot see
+// is configured separately (nmeaLatencyUs).
+//
+// SNTP: each completed sync is one reference. It is used only when GPS has
+// not delivered a reference recently.
+//
+// Readers convert with clock_to_utc() on a copy of the ClockModel; the
+// discipline itself has a single owner.
+
+#define CLOCK_FIT_POINTS 16                 // With one reference a minute, a 15 minute fit
+#define CLOCK_MIN_FIT_SPAN_US 120000000LL   // Drift needs references at least 2 minutes apart
+#define CLOCK_MAX_DRIFT_PPB 500000          // Crystal error beyond 500 ppm is a bad reference
+
+enum TimeSource : uint8_t {
+  TIME_SOURCE_NONE = 0,
+  TIME_SOURCE_SNTP = 1,
+  TIME_SOURCE_GPS = 2
+};
+
+struct ClockModel {
+  int64_t refMonoUs;       // Fit anchor
+  int64_t refUtcUs;
+  int64_t syncMonoUs;      // Newest reference
+  int32_t driftPpb;        // UTC gained per monotonic second, in ns
+  uint32_t uncertaintyUs;  // Source error plus the newest reference's fit residual
+  uint8_t source;          // TimeSource of the newest reference
+  uint8_t valid;
+};
+
+inline int64_t clock_to_utc(const ClockModel &model, int64_t monoUs) {
+  const int64_t dt = monoUs - model.refMonoUs;
+  return model.refUtcUs + dt + dt * model.driftPpb / 1000000000LL;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+inline int64_t clock_days_from_civil(int year, unsigned month, unsigned day) {
+  year -= month <= 2;
+  const int64_t era = (year >= 0 ? year : year - 399) / 400;
+  const unsigned yoe = (unsigned)(year - era * 400);
+  const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int64_t)doe - 719468;
+}
+
+inline int64_t clock_utc_from_civil(int year, unsigned month, unsigned day, unsigned hour,
+                                    unsigned minute, unsigned second, unsigned centisecond) {
+  const int64_t seconds = clock_days_from_civil(year, month, day) * 86400LL + hour * 3600 + minute * 60 + second;
+  return seconds * 1000000LL + centisecond * 10000LL;
+}
+
+class ClockDiscipline {
+ public:
+  // stepUs: a reference this far from the model restarts the fit instead of joining it
+  ClockDiscipline(int64_t gpsWindowUs, int64_t gpsFreshUs, int64_t stepUs, uint32_t gpsUncertaintyUs,
+                  uint32_t sntpUncertaintyUs, int64_t nmeaLatencyUs)
+      : gpsWindowUs_(gpsWindowUs), gpsFreshUs_(gpsFreshUs), stepUs_(stepUs),
+        gpsUncertaintyUs_(gpsUncertaintyUs), sntpUncertaintyUs_(sntpUncertaintyUs),
+        nmeaLatencyUs_(nmeaLatencyUs) {}
+
+  // One GPS sentence: UTC it reports and when its first byte arrived. Returns
+  // true when a window closed and the model changed.
+  bool addGps(int64_t arrivalMonoUs, int64_t utcUs) {
+    const int64_t offset = utcUs - arrivalMonoUs + nmeaLatencyUs_;
+    if (windowCount_ == 0) {
+      windowStartUs_ = arrivalMonoUs;
+      bestOffset_ = offset;
+      bestMonoUs_ = arrivalMonoUs;
+    } else if (offset > bestOffset_) {
+      bestOffset_ = offset;
+      bestMonoUs_ = arrivalMonoUs;
+    }
+    windowCount_++;
+    if (arrivalMonoUs - windowStartUs_ < gpsWindowUs_) return false;
+
+    windowCount_ = 0;
+    lastGpsUs_ = bestMonoUs_;
+    return addReference(TIME_SOURCE_GPS, bestMonoUs_, bestOffset_, gpsUncertaintyUs_);
+  }
+
+  // One completed SNTP sync. Ignored while GPS references are fresh.
+  bool addSntp(int64_t monoUs, int64_t utcUs) {
+    if (lastGpsUs_ != 0 && monoUs - lastGpsUs_ < gpsFreshUs_) {
+      sntpIgnored_++;
+      return false;
+    }
+    return addReference(TIME_SOURCE_SNTP, monoUs, utcUs - monoUs, sntpUncertaintyUs_);
+  }
+
+  const ClockModel &model() const { return model_; }
+  int64_t lastResidualUs() const { return lastResidualUs_; }
+  uint32_t references() const { return references_; }
+  uint32_t steps() const { return steps_; }
+  uint32_t sntpIgnored() const { return sntpIgnored_; }
+
+ private:
+  bool addReference(uint8_t source, int64_t monoUs, int64_t offsetUs, uint32_t sourceUncertaintyUs) {
+    const int64_t predicted = model_.valid ? clock_to_utc(model_, monoUs) - monoUs : offsetUs;
+    lastResidualUs_ = offsetUs - predicted;
+    const int64_t residual = lastResidualUs_ < 0 ? -lastResidualUs_ : lastResidualUs_;
+
+    // First reference, a switch of source or a jump: start the fit again
+    // from this reference, keeping the drift learnt so far
+    if (!model_.valid || source != model_.source || residual > stepUs_) {
+      if (model_.valid) steps_++;
+      count_ = 0;
+    }
+    if (count_ == CLOCK_FIT_POINTS) {
+      for (size_t i = 1; i < CLOCK_FIT_POINTS; i++) points_[i - 1] = points_[i];
+      count_--;
+    }
+    points_[count_++] = {monoUs, offsetUs};
+    references_++;
+
+    fit(source, sourceUncertaintyUs + (uint32_t)(count_ > 1 ? residual : 0));
+    return true;
+  }
+
+  // Least squares over the retained references, relative to the newest one
+  void fit(uint8_t source, uint32_t uncertaintyUs) {
+    const Point &newest = points_[count_ - 1];
+    int32_t drift = model_.valid ? model_.driftPpb : 0;
+    int64_t offset = newest.offsetUs;
+
+    if (count_ >= 3 && newest.monoUs - points_[0].monoUs >= CLOCK_MIN_FIT_SPAN_US) {
+      double sx = 0, sy = 0, sxx = 0, sxy = 0;
+      for (size_t i = 0; i < count_; i++) {
+        const double x = (double)(points_[i].monoUs - newest.monoUs);
+        const double y = (double)(points_[i].offsetUs - newest.offsetUs);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+      }
+      const double n = (double)count_;
+      const double denom = n * sxx - sx * sx;
+      if (denom > 0) {
+        const double slope = (n * sxy - sx * sy) / denom;
+        const double intercept = (sy - slope * sx) / n;
+        const double ppb = slope * 1e9;
+        if (ppb < CLOCK_MAX_DRIFT_PPB && ppb > -CLOCK_MAX_DRIFT_PPB) {
+          drift = (int32_t)ppb;
+          offset = newest.offsetUs + (int64_t)intercept;
+        }
+      }
+    }
+
+    model_.refMonoUs = newest.monoUs;
+    model_.refUtcUs = newest.monoUs + offset;
+    model_.syncMonoUs = newest.monoUs;
+    model_.driftPpb = drift;
+    model_.uncertaintyUs = uncertaintyUs;
+    model_.source = source;
+    model_.valid = 1;
+  }
+
+  struct Point {
+    int64_t monoUs;
+    int64_t offsetUs;   // UTC - monotonic
+  };
+
+  const int64_t gpsWindowUs_;
+  const int64_t gpsFreshUs_;
+  const int64_t stepUs_;
+  const uint32_t gpsUncertaintyUs_;
+  const uint32_t sntpUncertaintyUs_;
+  const int64_t nmeaLatencyUs_;
+
+  ClockModel model_ = {};
+  Point points_[CLOCK_FIT_POINTS] = {};
+  size_t count_ = 0;
+
+  int64_t windowStartUs_ = 0;
+  int64_t bestOffset_ = 0;
+  int64_t bestMonoUs_ = 0;
+  uint32_t windowCount_ = 0;
+  int64_t lastGpsUs_ = 0;
+
+  int64_t lastResidualUs_ = 0;
+  uint32_t references_ = 0;
+  uint32_t steps_ = 0;
+  uint32_t sntpIgnored_ = 0;
+};
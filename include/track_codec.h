@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Online GPS track compression for trip recording.
+//
+// TrackSimplifier is an opening-window (streaming Douglas-Peucker) filter.
+// It buffers the fixes after the last kept one and keeps a fix only when the
+// straight, constant-speed run from the last kept fix to the newest one would
+// leave a buffered fix more than toleranceM (or speedToleranceCms) away from
+// where the run places it at that fix's timestamp. A fix is also kept after
+// maxGapMs or TRACK_WINDOW buffered fixes. Every dropped fix is therefore
+// within tolerance of the decoded track.
+//
+// Kept fixes are delta encoded into self-contained segments:
+//   version u8 | count u8 | count x (dt varint, dLat zigzag, dLng zigzag, dSpeed zigzag)
+// The first point of a segment is a delta from zero, so any segment can be
+// decoded on its own. Varints are LEB128 (7 bits per byte, low bits first).
+
+#define TRACK_FORMAT_VERSION 1
+#define TRACK_SEGMENT_BYTES 256
+#define TRACK_MAX_POINT_BYTES 20  // Worst case: four 5-byte varints
+#define TRACK_SEGMENT_HEADER 2
+#define TRACK_WINDOW 64           // Fixes buffered before one is kept regardless
+
+struct TrackFix {
+  uint32_t timeMs;
+  int32_t latE7;      // Degrees x 1e7
+  int32_t lngE7;
+  uint16_t speedCms;  // Ground speed in cm/s
+};
+
+inline uint32_t track_zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+inline int32_t track_unzigzag(uint32_t v) {
+  return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// Difference with wrap-around, so longitude deltas across the antimeridian cannot overflow
+inline int32_t track_delta(int32_t a, int32_t b) {
+  return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
+inline size_t track_put_varint(uint8_t *out, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+inline bool track_get_varint(const uint8_t *&p, const uint8_t *end, uint32_t &v) {
+  v = 0;
+  for (int shift = 0; shift < 35 && p < end; shift += 7) {
+    const uint8_t byte = *p++;
+    v |= (uint32_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+class TrackSimplifier {
+ public:
+  TrackSimplifier(float toleranceM, uint16_t speedToleranceCms, uint32_t maxGapMs)
+      : toleranceM_(toleranceM), speedToleranceCms_(speedToleranceCms), maxGapMs_(maxGapMs) {}
+
+  void reset() {
+    haveAnchor_ = false;
+    count_ = 0;
+  }
+
+  // Feeds one fix. Returns true with `kept` set when a fix must be stored.
+  bool add(const TrackFix &fix, TrackFix &kept) {
+    if (!haveAnchor_) {
+      setAnchor(fix);
+      kept = fix;
+      return true;
+    }
+
+    if (count_ < TRACK_WINDOW && fix.timeMs - anchor_.timeMs <= maxGapMs_ && windowFits(fix)) {
+      window_[count_++] = fix;
+      return false;
+    }
+
+    // The chord to `fix` no longer covers the window: keep the newest fix that did
+    if (count_ == 0) {
+      setAnchor(fix);
+      kept = fix;
+      return true;
+    }
+    kept = window_[count_ - 1];
+    setAnchor(kept);
+    window_[count_++] = fix;
+    return true;
+  }
+
+  // End of trip: returns the final fix if it has not been kept yet
+  bool flush(TrackFix &kept) {
+    if (count_ == 0) return false;
+    kept = window_[count_ - 1];
+    setAnchor(kept);
+    return true;
+  }
+
+ private:
+  static constexpr float kMetresPerE7 = 0.0111319f;  // Along a meridian
+
+  void setAnchor(const TrackFix &fix) {
+    anchor_ = fix;
+    haveAnchor_ = true;
+    count_ = 0;
+    lngScale_ = kMetresPerE7 * std::cos(fix.latE7 * 1.745329e-9f);
+  }
+
+  // Every buffered fix must lie within tolerance of the anchor-to-`fix`
+  // chord at its own timestamp (synchronised Euclidean distance)
+  bool windowFits(const TrackFix &fix) const {
+    const float span = (float)(fix.timeMs - anchor_.timeMs);
+    if (span <= 0.0f) return true;
+    const float chordLat = (float)track_delta(fix.latE7, anchor_.latE7);
+    const float chordLng = (float)track_delta(fix.lngE7, anchor_.lngE7);
+    const float chordSpeed = (float)fix.speedCms - anchor_.speedCms;
+    const float limitE7 = toleranceM_ / kMetresPerE7;
+    const float limitSq = limitE7 * limitE7;
+    const float lngRatio = lngScale_ / kMetresPerE7;
+
+    for (size_t i = 0; i < count_; i++) {
+      const TrackFix &w = window_[i];
+      const float f = (float)(w.timeMs - anchor_.timeMs) / span;
+      const float dLat = (float)track_delta(w.latE7, anchor_.latE7) - f * chordLat;
+      const float dLng = ((float)track_delta(w.lngE7, anchor_.lngE7) - f * chordLng) * lngRatio;
+      if (dLat * dLat + dLng * dLng > limitSq) return false;
+      const float dSpeed = (float)w.speedCms - anchor_.speedCms - f * chordSpeed;
+      if (dSpeed > speedToleranceCms_ || -dSpeed > speedToleranceCms_) return false;
+    }
+    return true;
+  }
+
+  const float toleranceM_;
+  const float speedToleranceCms_;
+  const uint32_t maxGapMs_;
+  TrackFix anchor_ = {};
+  bool haveAnchor_ = false;
+  TrackFix window_[TRACK_WINDOW];
+  size_t count_ = 0;
+  float lngScale_ = kMetresPerE7;
+};
+
+// Builds one segment in a fixed buffer
+class TrackSegmentWriter {
+ public:
+  TrackSegmentWriter() { reset(); }
+
+  void reset() {
+    buffer_[0] = TRACK_FORMAT_VERSION;
+    buffer_[1] = 0;
+    length_ = TRACK_SEGMENT_HEADER;
+    prev_ = {};
+  }
+
+  // False when the segment is full; write it out, reset and append again
+  bool append(const TrackFix &fix) {
+    if (buffer_[1] == 255 || length_ + TRACK_MAX_POINT_BYTES > TRACK_SEGMENT_BYTES) return false;
+    length_ += track_put_varint(buffer_ + length_, fix.timeMs - prev_.timeMs);
+    length_ += track_put_varint(buffer_ + length_, track_zigzag(track_delta(fix.latE7, prev_.latE7)));
+    length_ += track_put_varint(buffer_ + length_, track_zigzag(track_delta(fix.lngE7, prev_.lngE7)));
+    length_ += track_put_varint(buffer_ + length_, track_zigzag((int32_t)fix.speedCms - prev_.speedCms));
+    buffer_[1]++;
+    prev_ = fix;
+    return true;
+  }
+
+  bool empty() const { return buffer_[1] == 0; }
+  size_t count() const { return buffer_[1]; }
+  const uint8_t *data() const { return buffer_; }
+  size_t size() const { return length_; }
+
+ private:
+  uint8_t buffer_[TRACK_SEGMENT_BYTES];
+  size_t length_;
+  TrackFix prev_;
+};
+
+// Decodes one segment. Returns the number of fixes, or -1 if it is malformed.
+inline int track_decode_segment(const uint8_t *data, size_t length, TrackFix *out, size_t maxFixes) {
+  if (length < TRACK_SEGMENT_HEADER || data[0] != TRACK_FORMAT_VERSION) return -1;
+  const size_t count = data[1];
+  if (count > maxFixes) return -1;
+
+  const uint8_t *p = data + TRACK_SEGMENT_HEADER;
+  const uint8_t *end = data + length;
+  TrackFix prev = {};
+  for (size_t i = 0; i < count; i++) {
+    uint32_t dt, dLat, dLng, dSpeed;
+    if (!track_get_varint(p, end, dt) || !track_get_varint(p, end, dLat) ||
+        !track_get_varint(p, end, dLng) || !track_get_varint(p, end, dSpeed)) {
+      return -1;
+    }
+    prev.timeMs += dt;
+    prev.latE7 = (int32_t)((uint32_t)prev.latE7 + (uint32_t)track_unzigzag(dLat));
+    prev.lngE7 = (int32_t)((uint32_t)prev.lngE7 + (uint32_t)track_unzigzag(dLng));
+    prev.speedCms = (uint16_t)(prev.speedCms + track_unzigzag(dSpeed));
+    out[i] = prev;
+  }
+  return p == end ? (int)count : -1;
+}
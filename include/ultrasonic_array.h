@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "seqlock.h"
+
+// Ranging with several HC-SR04 sensors. Sensors are described in a table and
+// assigned to trigger slots: sensors that can hear each other's bursts must be
+// in different slots, sensors in the same slot fire together. Slots run in
+// turn, each lasting until every sensor in it has echoed (or timed out) plus
+// a guard time for reverberation.
+//
+// All echo pins share one ISR. It passes the sensor index to EchoDemux, which
+// timestamps edges and publishes each finished echo in that sensor's slot,
+// overwriting the one before: a reader only ever wants the newest distance.
+
+#define ULTRASONIC_MAX_SENSORS 8
+
+struct UltrasonicSensorConfig {
+  const char *name;
+  uint8_t trigPin;
+  uint8_t echoPin;
+  uint8_t slot;      // Trigger slot, 0..slots-1
+  bool forward;      // Counts towards the distance used for motor control
+};
+
+struct EchoSample {
+  uint32_t timeUs;   // Falling edge
+  uint32_t echoUs;   // Echo pulse width
+};
+
+// Round trip at 340 m/s
+inline long echo_to_cm(uint32_t echoUs) {
+  return (long)((echoUs * 34) / 2000);
+}
+
+// Number of trigger slots in a sensor table (highest slot + 1)
+inline uint8_t ultrasonic_slot_count(const UltrasonicSensorConfig *sensors, size_t count) {
+  uint8_t slots = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (sensors[i].slot + 1 > slots) slots = sensors[i].slot + 1;
+  }
+  return slots;
+}
+
+// Bit mask of the sensors that fire in `slot`
+inline uint32_t ultrasonic_slot_mask(const UltrasonicSensorConfig *sensors, size_t count, uint8_t slot) {
+  uint32_t mask = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (sensors[i].slot == slot) mask |= 1u << i;
+  }
+  return mask;
+}
+
+template <size_t MaxSensors>
+class EchoDemux {
+  static_assert(MaxSensors <= 32, "EchoDemux tracks sensors in a 32-bit mask");
+
+ public:
+  // Trigger side, before firing a slot. Echoes from sensors outside `mask`
+  // (late echoes from the previous slot, crosstalk) are ignored. A sensor
+  // whose echo line is still high from an earlier burst ignores its trigger,
+  // so it is left out rather than holding the slot open until the timeout.
+  // Returns the sensors that will be waited for.
+  uint32_t arm(uint32_t mask) {
+    const uint32_t busy = mask & high_.load(std::memory_order_relaxed);
+    const uint32_t armed = mask & ~busy;
+    rising_.store(0, std::memory_order_relaxed);
+    const uint32_t missed = pending_.exchange(armed, std::memory_order_acq_rel);
+    if (missed) timeouts_.fetch_add(popcount(missed), std::memory_order_relaxed);
+    if (busy) busySkips_.fetch_add(popcount(busy), std::memory_order_relaxed);
+    return armed;
+  }
+
+  // ISR side, called for every edge on a sensor's echo pin. Returns true when
+  // this edge completed the last pending echo of the slot.
+  bool onEdge(uint8_t sensor, bool high, uint32_t nowUs) {
+    const uint32_t bit = 1u << sensor;
+    if (high) {
+      high_.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+      high_.fetch_and(~bit, std::memory_order_relaxed);
+    }
+    if (!(pending_.load(std::memory_order_relaxed) & bit)) {
+      ignored_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (high) {
+      riseUs_[sensor] = nowUs;
+      rising_.fetch_or(bit, std::memory_order_relaxed);
+      return false;
+    }
+    if (!(rising_.load(std::memory_order_relaxed) & bit)) return false;
+    rising_.fetch_and(~bit, std::memory_order_relaxed);
+
+    EchoSample sample = {nowUs, nowUs - riseUs_[sensor]};
+    latest_[sensor].write(sample);
+    echoes_.fetch_add(1, std::memory_order_relaxed);
+    return (pending_.fetch_and(~bit, std::memory_order_acq_rel) & ~bit) == 0;
+  }
+
+  // Consumer side, one consumer per sensor: the newest echo, if one finished
+  // since the last call. Echoes overwritten before they were read count as
+  // superseded.
+  bool latest(uint8_t sensor, EchoSample &sample) {
+    while (true) {
+      const uint32_t seq = latest_[sensor].sequence();
+      if (seq == seen_[sensor]) return false;
+      if (!latest_[sensor].tryRead(sample) || latest_[sensor].sequence() != seq) continue;
+      const uint32_t unread = (seq - seen_[sensor]) / 2 - 1;
+      if (unread) superseded_[sensor].fetch_add(unread, std::memory_order_relaxed);
+      seen_[sensor] = seq;
+      return true;
+    }
+  }
+
+  uint32_t pending() const { return pending_.load(std::memory_order_acquire); }
+  uint32_t echoes() const { return echoes_.load(std::memory_order_relaxed); }
+  uint32_t timeouts() const { return timeouts_.load(std::memory_order_relaxed); }
+  uint32_t ignored() const { return ignored_.load(std::memory_order_relaxed); }
+  uint32_t busySkips() const { return busySkips_.load(std::memory_order_relaxed); }
+  uint32_t superseded(uint8_t sensor) const { return superseded_[sensor].load(std::memory_order_relaxed); }
+
+ private:
+  static uint32_t popcount(uint32_t v) {
+    uint32_t n = 0;
+    for (; v; v &= v - 1) n++;
+    return n;
+  }
+
+  std::atomic<uint32_t> pending_{0};
+  std::atomic<uint32_t> rising_{0};
+  std::atomic<uint32_t> high_{0};     // Echo lines currently high
+  uint32_t riseUs_[MaxSensors] = {};
+  SeqLock<EchoSample> latest_[MaxSensors];
+  uint32_t seen_[MaxSensors] = {};    // Consumer side: last sequence read
+  std::atomic<uint32_t> superseded_[MaxSensors] = {};
+  std::atomic<uint32_t> echoes_{0};
+  std::atomic<uint32_t> timeouts_{0};
+  std::atomic<uint32_t> ignored_{0};
+  std::atomic<uint32_t> busySkips_{0};
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Windowed vibration analysis: RMS, peak and FFT band energies per window of
+// raw ADC samples. Buffers are structure-of-arrays float so the butterfly and
+// power loops stay branch-free and vectorize on the host.
+
+#define VIBRATION_BANDS 4
+
+enum RoadCondition : uint8_t {
+  ROAD_SMOOTH = 0,
+  ROAD_ROUGH = 1,
+  ROAD_IMPACT = 2,
+};
+
+struct VibrationFeatures {
+  uint32_t windowEndMs;
+  float rms;                              // AC RMS in ADC counts
+  uint16_t peak;                          // Largest raw sample in the window
+  uint16_t peakToPeak;
+  float bandEnergy[VIBRATION_BANDS];      // Mean-square ADC counts per band
+  uint8_t roadCondition;
+};
+
+template <size_t N>
+class VibrationAnalyzer {
+  static_assert(N >= 8 && (N & (N - 1)) == 0, "VibrationAnalyzer window must be a power of two");
+  static constexpr size_t M = N / 2;  // Complex FFT size for the packed real input
+
+ public:
+  // bandEdgesHz holds VIBRATION_BANDS + 1 ascending edges
+  VibrationAnalyzer(float sampleRateHz, const float *bandEdgesHz) {
+    const double twoPi = 6.283185307179586;
+    double windowPower = 0;
+    for (size_t n = 0; n < N; n++) {
+      window_[n] = (float)(0.5 - 0.5 * std::cos(twoPi * n / N));  // Hann
+      windowPower += (double)window_[n] * window_[n];
+    }
+    // Scale so the band energies sum to the windowed signal's mean square
+    powerScale_ = (float)(2.0 / (N * windowPower));
+
+    for (size_t k = 0; k < M; k++) {
+      twRe_[k] = (float)std::cos(twoPi * k / N);
+      twIm_[k] = (float)-std::sin(twoPi * k / N);
+    }
+
+    unsigned bits = 0;
+    while ((1u << bits) < M) bits++;
+    for (size_t i = 0; i < M; i++) {
+      size_t r = 0;
+      for (unsigned b = 0; b < bits; b++) {
+        r |= ((i >> b) & 1u) << (bits - 1 - b);
+      }
+      bitrev_[i] = (uint16_t)r;
+    }
+
+    const float binHz = sampleRateHz / N;
+    for (int b = 0; b <= VIBRATION_BANDS; b++) {
+      long bin = lround(bandEdgesHz[b] / binHz);
+      if (bin < 1) bin = 1;  // Never count the DC bin
+      if (bin > (long)M + 1) bin = M + 1;
+      bandBin_[b] = (uint16_t)bin;
+    }
+  }
+
+  void analyze(const uint16_t *samples, VibrationFeatures &out) {
+    // Time-domain statistics
+    uint32_t sum = 0;
+    uint16_t peak = 0, trough = UINT16_MAX;
+    for (size_t n = 0; n < N; n++) {
+      const uint16_t s = samples[n];
+      sum += s;
+      if (s > peak) peak = s;
+      if (s < trough) trough = s;
+    }
+    const float mean = (float)sum / N;
+    float sumSq = 0;
+    for (size_t n = 0; n < N; n++) {
+      const float d = samples[n] - mean;
+      sumSq += d * d;
+    }
+    out.rms = std::sqrt(sumSq / N);
+    out.peak = peak;
+    out.peakToPeak = peak - trough;
+
+    // Pack even/odd samples into one half-size complex FFT, DC removed and windowed
+    for (size_t n = 0; n < M; n++) {
+      const size_t j = bitrev_[n];
+      re_[j] = (samples[2 * n] - mean) * window_[2 * n];
+      im_[j] = (samples[2 * n + 1] - mean) * window_[2 * n + 1];
+    }
+    fft();
+
+    // Split the packed spectrum into the real signal's bins and accumulate bands
+    for (int b = 0; b < VIBRATION_BANDS; b++) out.bandEnergy[b] = 0;
+    for (size_t k = 1; k <= M; k++) {
+      const size_t a = k % M;
+      const size_t c = (M - k) % M;
+      // Even and odd half spectra
+      const float evRe = 0.5f * (re_[a] + re_[c]);
+      const float evIm = 0.5f * (im_[a] - im_[c]);
+      const float odRe = 0.5f * (im_[a] + im_[c]);
+      const float odIm = -0.5f * (re_[a] - re_[c]);
+      float xRe, xIm;
+      if (k < M) {
+        xRe = evRe + twRe_[k] * odRe - twIm_[k] * odIm;
+        xIm = evIm + twRe_[k] * odIm + twIm_[k] * odRe;
+      } else {
+        xRe = evRe - odRe;  // Nyquist bin
+        xIm = 0;
+      }
+      const float power = (xRe * xRe + xIm * xIm) * (k < M ? powerScale_ : 0.5f * powerScale_);
+      for (int b = 0; b < VIBRATION_BANDS; b++) {
+        if (k >= bandBin_[b] && k < bandBin_[b + 1]) out.bandEnergy[b] += power;
+      }
+    }
+  }
+
+  static constexpr size_t windowSize() { return N; }
+
+ private:
+  // Iterative radix-2 decimation-in-time FFT on re_/im_ (input already bit-reversed)
+  void fft() {
+    for (size_t len = 2; len <= M; len <<= 1) {
+      const size_t half = len >> 1;
+      const size_t step = N / len;  // W_len^j == W_N^(j * N / len)
+      for (size_t i = 0; i < M; i += len) {
+        for (size_t j = 0; j < half; j++) {
+          const float wr = twRe_[j * step];
+          const float wi = twIm_[j * step];
+          const float tr = wr * re_[i + j + half] - wi * im_[i + j + half];
+          const float ti = wr * im_[i + j + half] + wi * re_[i + j + half];
+          re_[i + j + half] = re_[i + j] - tr;
+          im_[i + j + half] = im_[i + j] - ti;
+          re_[i + j] += tr;
+          im_[i + j] += ti;
+        }
+      }
+    }
+  }
+
+  float window_[N];
+  float twRe_[M], twIm_[M];
+  float re_[M], im_[M];
+  uint16_t bitrev_[M];
+  uint16_t bandBin_[VIBRATION_BANDS + 1];
+  float powerScale_;
+};
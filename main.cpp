@@ -6,49 +6,101 @@
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
+#include <WebSocketsClient.h>
+#include <esp_task_wdt.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
+#include "spsc_queue.h"
+#include "fast_math.h"
+#include "orientation_filter.h"
+#include "vibration_features.h"
+#include "control_logic.h"
+#include "sensor_trace.h"
+#include "stream_channel.h"
+#include "deadline_monitor.h"
+#include "seqlock.h"
+#include "track_codec.h"
+#include "ultrasonic_array.h"
+#include "alert_orchestrator.h"
+#include "board_config.h"
+#include "schedule.h"
+#include "time_service.h"
+#include "link_manager.h"
+#include "i2c_bus.h"
+#include "lcd_backpack.h"
+#include "telemetry_payload.h"
+
+// Raw sensor trace recording: 0 = off, 1 = framed stream on Serial, 2 = LittleFS file
+#ifndef SAFEDRIVE_TRACE
+#define SAFEDRIVE_TRACE 0
+#endif
+#include <LittleFS.h>
+#include <Preferences.h>
+#include "bench.h"
 
 // Add after other includes
 #define XSTR(x) STR(x)    // Convert macro value to string
 #define STR(x) #x         // Convert token to string
 
-// LCD setup
-#define I2C_SDA 21
-#define I2C_SCL 22
+// LCD setup (pins per board variant, see board_config.h)
+#define I2C_SDA Board::i2cSda
+#define I2C_SCL Board::i2cScl
 #define LCD_ADDRESS 0x27  // Usually 0x27 or 0x3F
 #define LCD_COLS 16
 #define LCD_ROWS 2
 
+// Shared I2C bus: the I2C task owns Wire and runs queued transactions, IMU
+// reads first (see i2c_bus.h). The LCD is redrawn cell by cell so an IMU read
+// never waits behind more than one short LCD write.
+#define I2C_IMU_CLOCK 400000       // Fast mode for the MPU6050
+#define I2C_LCD_CLOCK 100000       // The PCF8574 backpack is rated for standard mode only
+#define I2C_TIMEOUT 10             // Give up on a stuck transaction after 10 ms
+#define I2C_TASK_STACK 4096
+#define I2C_TASK_PRIORITY 2        // Above the control loop, so a queued read starts at once
+#define I2C_QUEUE_SIZE 16
+#define I2C_LEVEL_IMU 0            // Priority levels, 0 first
+#define I2C_LEVEL_DISPLAY 1
+#define I2C_LEVELS 2
+#define IMU_ADDRESS 0x68
+#define IMU_REG_ACCEL_XOUT_H 0x3B  // Accel, temperature and gyro follow in one 14-byte burst
+#define IMU_READ_TIMEOUT 2         // Longest the control loop waits for a read (ms)
+#define IMU_ACCEL_LSB_PER_G 4096.0f   // MPU6050_RANGE_8_G, see init_mpu()
+#define IMU_GYRO_LSB_PER_DPS 65.5f    // MPU6050_RANGE_500_DEG
+
 // WiFi setup
 #define WIFI_SSID "Run wale"     // Change this to your WiFi SSID
 #define WIFI_PASSWORD "1234567890"  // Change this to your WiFi password
+// The link is managed from the network task without blocking (see
+// link_manager.h). Reconnects first try the cached BSSID, channel and lease.
+#define WIFI_FAST_TIMEOUT 3000         // Give up on a cached-BSSID attempt after 3 s
+#define WIFI_SCAN_TIMEOUT 15000        // and on a full scan with DHCP after 15 s
+#define WIFI_BACKOFF_MIN 2000          // Wait between failed scans, doubling each time
+#define WIFI_BACKOFF_MAX 15000         // Keep retrying often, dead zones are short
+#define WIFI_CACHE_IP 1                // Reuse the last DHCP lease on fast reconnects
 
 // GPS setup
-#define GPS_TX_PIN 26
-#define GPS_RX_PIN 5
+#define GPS_TX_PIN Board::gpsRx   // GPS TX, ESP32 RX
+#define GPS_RX_PIN Board::gpsTx
 
 // GSM setup
-#define GSM_TX_PIN 27
-#define GSM_RX_PIN 19
+#define GSM_TX_PIN Board::gsmRx   // GSM TX, ESP32 RX
+#define GSM_RX_PIN Board::gsmTx
 #define EMERGENCY_PHONE_NUMBER "+233557043125" // <-- Change this to your desired phone number
 
 // Heart pulse sensor setup
-#define PULSE_PIN 33
-#define WIFI_LED_PIN 2  // Add LED pin definition
+#define PULSE_PIN Board::pulse
+#define WIFI_LED_PIN Board::wifiLed
 
 // Hall sensor setup
-#define HALL_PIN 35
+#define HALL_PIN Board::hall
 #define SEAT_BELT_TIMEOUT 10000  // 10 seconds timeout
 #define SEAT_BELT_THRESHOLD 2000  // Adjust based on your hall sensor
 
 // Add after other pin definitions
-#define MQ3_PIN 32
-#define ALCOHOL_LED_PIN 0
-#define ALCOHOL_THRESHOLD 500    // Reduced from 1000 to 500 for better sensitivity
+#define MQ3_PIN Board::mq3
+#define ALCOHOL_LED_PIN Board::alcoholLed
 #define ALCOHOL_SAMPLES 10        // More samples for better averaging
-#define ALCOHOL_READ_DELAY 100    // Delay between readings
-
-// Add these definitions after other #defines
-#define MESSAGE_INTERVAL 10800000  // 3 hours in milliseconds
+#define ALCOHOL_SAMPLE_INTERVAL 100   // One MQ-3 read per control job (ms); pipeline settings in control_logic.h
 
 // Update backend settings
 #define BACKEND_URL "https://safedrive-backend-4h5k.onrender.com/api/sensor"
@@ -59,6 +111,68 @@
 #define BACKEND_UPDATE_INTERVAL 5000  // Send data every 5 seconds
 #define API_KEY "safedrive_secret_key"       // Add your backend API key
 
+// Trip recording: every GPS fix is compressed online (see track_codec.h),
+// stored per trip on LittleFS and uploaded one segment per POST
+#define BACKEND_TRIP_URL "https://safedrive-backend-4h5k.onrender.com/api/trip"
+#define TRIP_DIR "/trips"
+#define TRACK_TOLERANCE_M 5.0f         // Max distance of a dropped fix from the stored track
+#define TRACK_SPEED_TOLERANCE 200      // Max speed error of a dropped fix (cm/s)
+#define TRACK_MAX_GAP 30000            // Keep at least one fix every 30 seconds
+#define TRACK_QUEUE_SIZE 16
+#define TRIP_START_SPEED 139           // A trip starts above 5 km/h (cm/s)
+#define TRIP_END_IDLE 180000           // and ends after 3 minutes below it
+#define TRIP_SEGMENT_INTERVAL 60000    // Close a partly filled segment after a minute
+#define TRIP_UPLOAD_INTERVAL 5000
+#define TRIP_MIN_FREE_BYTES 65536      // Stop recording before the filesystem fills
+
+// Real-time WebSocket stream to the dashboard, alongside the 5 s HTTP POST.
+// For a local test run tools/stream_echo_server.js and point STREAM_HOST at it
+// with STREAM_USE_TLS 0.
+#define STREAM_HOST "safedrive-backend-4h5k.onrender.com"
+#define STREAM_PORT 443
+#define STREAM_PATH "/stream"
+#define STREAM_USE_TLS 1
+#define STREAM_RATE_HZ 10              // Default frame rate, the server can change it (1-10 Hz)
+#define STREAM_MAX_IN_FLIGHT 2         // Unacknowledged frames before new ones are coalesced
+#define STREAM_ACK_TIMEOUT 2000000     // Give up on an ack after 2 s (us)
+#define STREAM_RECONNECT_INTERVAL 5000
+#define STREAM_TASK_INTERVAL 5         // Stream task poll period (ms)
+#define STREAM_TASK_STACK 8192
+#define STREAM_TASK_PRIORITY 2         // Above the network task so a blocking POST can't delay frames
+#define STREAM_QUEUE_SIZE 4
+
+// Emergency alerts: a confirmed accident goes to the Alert task, which texts
+// every contact and then calls EMERGENCY_PHONE_NUMBER over GSM, while the
+// AlertPost task sends the high-priority event to the backend over WiFi
+#define BACKEND_ACCIDENT_URL "https://safedrive-backend-4h5k.onrender.com/api/accident"
+#define ALERT_TASK_STACK 6144
+#define ALERT_TASK_PRIORITY 3          // Above the stream and network tasks
+#define ALERT_TASK_INTERVAL 10         // GSM poll period (ms)
+#define ALERT_POST_TASK_STACK 8192
+#define ALERT_POST_TASK_PRIORITY 3
+#define ALERT_QUEUE_SIZE 4
+#define ALERT_AT_TIMEOUT 5000          // Modem reply to a plain AT command
+#define ALERT_SMS_TIMEOUT 60000        // Network acceptance of an SMS (+CMGS)
+#define ALERT_SMS_RETRIES 2            // Extra attempts per contact
+#define ALERT_DIAL_TIMEOUT 20000       // Modem accepting the ATD
+#define ALERT_CALL_DURATION 30000      // Hang up the voice call after 30 s
+#define ALERT_POST_RETRIES 3
+#define ALERT_POST_TIMEOUT 5000        // HTTP timeout per attempt (ms)
+
+// Device clock: esp_timer microseconds disciplined to UTC from GPS time, or
+// from SNTP while there is no GPS (see time_service.h). Samples and stream
+// frames carry their monotonic capture time and are stamped with UTC when sent.
+#define TIME_NTP_SERVER_1 "pool.ntp.org"
+#define TIME_NTP_SERVER_2 "time.google.com"
+#define TIME_SNTP_SYNC_INTERVAL 600000    // ms
+#define TIME_GPS_WINDOW 60000000          // One GPS reference per minute of sentences (us)
+#define TIME_GPS_FRESH 120000000          // Ignore SNTP within 2 minutes of a GPS reference (us)
+#define TIME_STEP_THRESHOLD 500000        // Restart the fit on a jump of 0.5 s (us)
+#define TIME_GPS_UNCERTAINTY 10000        // '$' stamps lag by up to a control tick, plus the filter's residual delay (us)
+#define TIME_SNTP_UNCERTAINTY 50000       // Half a typical mobile hotspot round trip (us)
+#define TIME_NMEA_LATENCY 0               // Module's fixed delay from the UTC second to its first '$' (us)
+#define TIME_QUEUE_SIZE 8
+
 // Add these global variables after the existing global variables
 TinyGPSPlus gps;
 unsigned long timestamp;
@@ -70,32 +184,41 @@ bool initialSamplesCollected = false;        // Flag for initial samples
 unsigned long lastMessageTime = 0;           // Last time a message was sent
 unsigned long lastBackendUpdate = 0;
 HTTPClient http;
-DynamicJsonDocument jsonDoc(512);
 
 // Add after other global variables
-#define VIBRATION_PIN 34
-#define ACCIDENT_THRESHOLD 3000  // Adjust based on your sensor
+#define VIBRATION_PIN Board::vibration
 #define ACCIDENT_COOLDOWN 60000  // 1 minute cooldown between accident alerts
-unsigned long lastAccidentTime = 0;
-bool accidentDetected = false;
+
+// Vibration capture: hardware-timer paced ADC samples analysed per window
+#define VIBRATION_SAMPLE_RATE 1000   // Samples per second
+#define VIBRATION_TIMER 0            // Hardware timer used for sampling
+#define VIBRATION_TASK_PRIORITY 4    // Above the ultrasonic task so samples stay evenly spaced
+#define VIBRATION_QUEUE_SIZE 8
 
 // Update ultrasonic sensor settings
-#define ULTRASONIC_TRIG 13
-#define ULTRASONIC_ECHO 14
-#define DISTANCE_LED_PIN 4
-#define SAFE_DISTANCE 200      // Increased safe distance to 2 meters
-#define WARNING_DISTANCE 150   // Early warning at 1.5 meters
-#define CRITICAL_DISTANCE 100  // Critical warning at 1 meter
-#define EMERGENCY_DISTANCE 50  // Emergency stop at 50cm
-#define ULTRASONIC_TIMEOUT 15000   // Reduced timeout for faster error detection
+#define ULTRASONIC_TRIG Board::ultrasonicTrig
+#define ULTRASONIC_ECHO Board::ultrasonicEcho
+#define DISTANCE_LED_PIN Board::distanceLed
+#define ULTRASONIC_TIMEOUT 15000   // Longest a trigger slot waits for its echoes (us)
 #define ULTRASONIC_MIN_DIST 5      // Minimum reliable distance (cm)
 #define ULTRASONIC_MAX_DIST 200    // Maximum reliable range for consistent readings
-#define ULTRASONIC_INTERVAL 2      // Reduce to 2ms between readings
-#define ULTRASONIC_READ_INTERVAL 10 // Reduce to 10ms
+#define ULTRASONIC_INTERVAL 2      // Guard between trigger slots for reverberation (ms)
 #define MAX_INVALID_READINGS 5      // More readings before confirming object removed
 #define READING_SAMPLES 5           // Number of samples to average
 #define ERROR_MARGIN 10            // 10cm error margin for distance readings
-#define MOTOR_RESPONSE_DELAY 50    // Quick motor response time
+
+// Ranging sensors (see ultrasonic_array.h). Sensors that can hear each other
+// need different slots; sensors sharing a slot fire together, so adding them
+// costs no update rate. Add the pins of new sensors to boardPins as well.
+constexpr UltrasonicSensorConfig ultrasonicSensors[] = {
+  // name          trig             echo             slot  forward
+  {"front",        ULTRASONIC_TRIG, ULTRASONIC_ECHO, 0,    true},
+  // {"rear",       18,              39,              0,    false},
+  // {"front_left", 25,              36,              1,    true},
+};
+const size_t ULTRASONIC_SENSOR_COUNT = sizeof(ultrasonicSensors) / sizeof(ultrasonicSensors[0]);
+static_assert(sizeof(ultrasonicSensors) / sizeof(ultrasonicSensors[0]) <= ULTRASONIC_MAX_SENSORS,
+              "Too many ultrasonic sensors");
 
 // Add validation counters
 #define READING_HISTORY_SIZE 5     // Keep track of last 5 readings
@@ -104,6 +227,9 @@ int readingIndex = 0;              // Current index in readings array
 
 // Add these definitions after other #defines
 #define SENSOR_UPDATE_INTERVAL 100   // Update sensors every 100ms
+#define MOTOR_UPDATE_INTERVAL 50     // Distance check and motor decision
+#define GPS_DISPLAY_INTERVAL 2000    // GPS position on the LCD
+#define GPS_REPORT_INTERVAL 5000     // GPS debug output
 #define DISPLAY_UPDATE_INTERVAL 1000 // Update display every 1 second
 
 // Add MPU threshold definitions after other #define statements
@@ -114,7 +240,6 @@ int readingIndex = 0;              // Current index in readings array
 // Add after other #defines
 #define BPM_THRESHOLD 1800     // Adjust for human pulse detection
 #define BPM_SAMPLE_TIME 15     // 15 seconds measurement window
-#define BPM_UPDATE_INTERVAL 20 // 20ms between samples
 #define PULSE_THRESHOLD 1000     // Lower threshold for human pulse
 #define PULSE_MAX_VALUE 2000     // Maximum expected value
 #define PULSE_MIN_VALUE 500      // Minimum expected value
@@ -123,22 +248,118 @@ int readingIndex = 0;              // Current index in readings array
 #define MAX_BPM 180             // Maximum human BPM
 
 // Add new threshold definitions
-#define RAPID_DECEL_THRESHOLD 3.0    // Sudden deceleration threshold in g
 #define TILT_ANGLE_THRESHOLD 45.0    // Vehicle tilt threshold in degrees
 #define BRAKE_DISTANCE 20           // Emergency brake distance in cm
-#define SPEED_CHECK_INTERVAL 100    // Speed check interval in ms
 
 // Add these definitions after other #defines
-#define IMPACT_THRESHOLD_LOW 3.0   // Light impact (g)
-#define IMPACT_THRESHOLD_HIGH 6.0  // Severe impact (g)
-#define TILT_THRESHOLD_ROLL 45.0  // Roll threshold (degrees)
-#define TILT_THRESHOLD_PITCH 30.0 // Pitch threshold (degrees)
 #define PRE_COLLISION_TIME 500    // Pre-collision warning time (ms)
 
+// Orientation filter settings
+#define IMU_FILTER_BETA 0.05f     // Madgwick gain: lower trusts the gyro more under vibration
+
 // Add system recovery settings
-#define SYSTEM_WATCHDOG_TIMEOUT 30000  // Reset system if frozen for 30 seconds
-#define SENSOR_ERROR_THRESHOLD 3       // Number of consecutive errors before recovery
-#define RECOVERY_DELAY 1000            // Time between recovery attempts
+#define SYSTEM_WATCHDOG_TIMEOUT 30000  // Reset system if a task stops feeding the watchdog for 30 seconds
+#define SENSOR_ERROR_THRESHOLD 3       // Consecutive control deadline misses before shedding load
+#define RECOVERY_DELAY 1000            // Time back on budget before shed work resumes
+
+// Deadline budgets per stage (see deadline_monitor.h)
+#define CONTROL_LOOP_BUDGET_US 4000       // Whole control loop, leaves slack in the 5 ms period
+#define BODY_SENSOR_BUDGET_US 6000000     // One pulse window plus the seat belt read
+#define BACKEND_POST_BUDGET_US 2000000    // HTTP POST to the backend
+#define DEADLINE_MAX_STAGES 8
+
+// Seat belt and pulse are slow blocking reads; they run in their own task on
+// CONTROL_CORE at idle priority. The Arduino loopTask (the control loop) runs
+// at priority 1, so an equal priority would round-robin time slices with it.
+#define BODY_SENSOR_TASK_STACK 4096
+#define BODY_SENSOR_TASK_PRIORITY 0
+#define BODY_SENSOR_QUEUE_SIZE 4
+#define BPM_WINDOW_SEC 5               // Pulse measurement window per reading
+
+// Task topology: acquisition and motor control own CONTROL_CORE (the Arduino
+// loop() core), WiFi/HTTP, GSM, logging and the LCD own NETWORK_CORE so a
+// stalled POST can never delay the safety path.
+#define CONTROL_CORE 1
+#define NETWORK_CORE 0
+#define CONTROL_LOOP_INTERVAL 5       // Control loop period (ms)
+#define NETWORK_TASK_INTERVAL 20      // Network task poll period (ms)
+#define NETWORK_TASK_STACK 8192
+#define NETWORK_TASK_PRIORITY 1
+#define TASK_STATS_INTERVAL 10000     // Report queue/core statistics every 10 seconds
+#define TELEMETRY_QUEUE_SIZE 16
+#define LCD_QUEUE_SIZE 8
+#define SNAPSHOT_READ_ATTEMPTS 4      // Vehicle snapshot reads before falling back to the queued sample
+
+// Task CPU budgets are checked per core against this limit (see taskBudgets)
+#define SCHEDULE_CORE_LOAD_LIMIT 700   // Per mille, leaves room for the WiFi stack and ISRs
+#define TLS_POST_CPU_US 400000         // Handshake plus request for one HTTPS POST
+
+// Trace recorder settings (see sensor_trace.h for the frame format)
+#define TRACE_QUEUE_SIZE 64             // Records from the control loop
+#define TRACE_VIBRATION_QUEUE_SIZE 32   // Records from the vibration task
+#define TRACE_BODY_QUEUE_SIZE 32        // Records from the body sensor task
+#define TRACE_FILE_PATH "/trace.bin"
+#define TRACE_MAX_FILE_BYTES 1000000    // Stop recording before the filesystem fills
+#define TRACE_FLUSH_INTERVAL 1000       // Flush the trace file every second
+#define TRACE_SERIAL_BAUD 921600        // A full trace is ~14 KB/s, too much for 115200
+
+#if SAFEDRIVE_TRACE
+// One queue per producing task keeps both single-producer
+SpscQueue<TraceRecord, TRACE_QUEUE_SIZE> traceQueue;
+SpscQueue<TraceRecord, TRACE_VIBRATION_QUEUE_SIZE> traceVibrationQueue;
+SpscQueue<TraceRecord, TRACE_BODY_QUEUE_SIZE> traceBodyQueue;
+uint32_t traceBytesWritten = 0;
+extern TaskHandle_t bodySensorTaskHandle;
+#if SAFEDRIVE_TRACE == 2
+File traceFile;
+#endif
+
+template <typename Queue>
+void trace_push(Queue &queue, uint32_t timeUs, uint8_t type, uint8_t channel, const void *payload, size_t length) {
+  TraceRecord record;
+  if (trace_make_record(record, timeUs, type, channel, payload, length)) {
+    queue.push(record);
+  }
+}
+
+// Record a raw sample from the control loop task
+void trace_control(uint8_t type, uint8_t channel, const void *payload, size_t length) {
+  trace_push(traceQueue, micros(), type, channel, payload, length);
+}
+
+// ADC reads come from the control loop or, for the slow body sensors, their own task
+void trace_adc(uint8_t channel, int value) {
+  uint16_t raw = value;
+  if (bodySensorTaskHandle != NULL && xTaskGetCurrentTaskHandle() == bodySensorTaskHandle) {
+    trace_push(traceBodyQueue, micros(), TRACE_ADC, channel, &raw, sizeof(raw));
+  } else {
+    trace_control(TRACE_ADC, channel, &raw, sizeof(raw));
+  }
+}
+
+// GPS UART bytes are batched into TRACE_NMEA records
+uint8_t traceNmea[TRACE_MAX_PAYLOAD];
+size_t traceNmeaLength = 0;
+
+void trace_nmea_flush() {
+  if (traceNmeaLength > 0) {
+    trace_control(TRACE_NMEA, 0, traceNmea, traceNmeaLength);
+    traceNmeaLength = 0;
+  }
+}
+
+void trace_nmea_byte(char c) {
+  traceNmea[traceNmeaLength++] = c;
+  if (traceNmeaLength == TRACE_MAX_PAYLOAD) {
+    trace_nmea_flush();
+  }
+}
+#else
+inline void trace_control(uint8_t, uint8_t, const void *, size_t) {}
+inline void trace_adc(uint8_t, int) {}
+inline void trace_nmea_flush() {}
+inline void trace_nmea_byte(char) {}
+#endif
 
 // Add these variables after other globals
 unsigned long lastSensorUpdate = 0;
@@ -147,6 +368,7 @@ unsigned long lastDisplayUpdate = 0;
 // Add before VehicleState struct
 bool check_seat_belt() {
   int hallValue = analogRead(HALL_PIN);
+  trace_adc(TRACE_ADC_HALL, hallValue);
   return hallValue < SEAT_BELT_THRESHOLD;
 }
 
@@ -157,38 +379,42 @@ struct VehicleState {
   long distance;
   int vibration;
   bool seatbelt;
-  int alcoholLevel;
+  int alcoholLevel;                         // Smoothed, temperature-compensated MQ-3 reading
+  uint8_t alcoholState;                     // AlcoholState
   float speed;
   int pulse;  // Add pulse field
+  float vibrationRms;                       // AC RMS of the last vibration window
+  float vibrationBands[VIBRATION_BANDS];    // Band energies of the last vibration window
+  uint8_t roadCondition;                    // ROAD_SMOOTH / ROAD_ROUGH / ROAD_IMPACT
 } vehicleState;
 
 // Add after the VehicleState struct definition
 void init_vehicle_state() {
   vehicleState.alcoholLevel = 0;
+  vehicleState.alcoholState = ALCOHOL_WARMING_UP;
   vehicleState.impact = 0;
   vehicleState.distance = 100;  // Default safe distance
   vehicleState.vibration = 0;
+  vehicleState.vibrationRms = 0;
+  memset(vehicleState.vibrationBands, 0, sizeof(vehicleState.vibrationBands));
+  vehicleState.roadCondition = ROAD_SMOOTH;
   vehicleState.pulse = 0;
+  vehicleState.speed = 0;
   vehicleState.seatbelt = check_seat_belt();
 }
 
 // Add after other global variables
 bool initialDataSent = false;
 
-// Add after other global variables
-bool accidentAlertSent = false;
-
 // Add new global variables
-float lastSpeed = 0;
-unsigned long lastSpeedCheck = 0;
 bool warningIssued = false;
 int dangerLevel = 0;  // 0=safe, 1=warning, 2=critical, 3=emergency
 
 // Add after other pin definitions
-#define MOTOR_IN1 16
-#define MOTOR_IN2 15
-#define MOTOR_IN3 23
-#define MOTOR_IN4 17
+#define MOTOR_IN1 Board::motorIn1
+#define MOTOR_IN2 Board::motorIn2
+#define MOTOR_IN3 Board::motorIn3
+#define MOTOR_IN4 Board::motorIn4
 
 // Add after other #defines
 #define MOTOR_SLOW_DISTANCE 50    // Distance at which to start slowing (cm)
@@ -198,36 +424,63 @@ int dangerLevel = 0;  // 0=safe, 1=warning, 2=critical, 3=emergency
 #define MOTOR_PWM_FREQ 5000       // PWM frequency
 #define MOTOR_PWM_RESOLUTION 8    // 8-bit resolution (0-255)
 
+// Every GPIO in use, checked against the selected board at compile time
+constexpr PinUse boardPins[] = {
+  {I2C_SDA,                        PIN_BUS,         "I2C SDA"},
+  {I2C_SCL,                        PIN_BUS,         "I2C SCL"},
+  {GPS_TX_PIN,                     PIN_DIGITAL_IN,  "GPS RX"},
+  {GPS_RX_PIN,                     PIN_DIGITAL_OUT, "GPS TX"},
+  {GSM_TX_PIN,                     PIN_DIGITAL_IN,  "GSM RX"},
+  {GSM_RX_PIN,                     PIN_DIGITAL_OUT, "GSM TX"},
+  {PULSE_PIN,                      PIN_ANALOG_IN,   "pulse"},
+  {WIFI_LED_PIN,                   PIN_DIGITAL_OUT, "WiFi LED"},
+  {HALL_PIN,                       PIN_ANALOG_IN,   "seat belt hall"},
+  {MQ3_PIN,                        PIN_ANALOG_IN,   "MQ3"},
+  {ALCOHOL_LED_PIN,                PIN_DIGITAL_OUT, "alcohol LED"},
+  {VIBRATION_PIN,                  PIN_ANALOG_IN,   "vibration"},
+  {ultrasonicSensors[0].trigPin,   PIN_DIGITAL_OUT, "front trig"},
+  {ultrasonicSensors[0].echoPin,   PIN_DIGITAL_IN,  "front echo"},
+  {DISTANCE_LED_PIN,               PIN_DIGITAL_OUT, "distance LED"},
+  {MOTOR_IN1,                      PIN_DIGITAL_OUT, "motor IN1"},
+  {MOTOR_IN2,                      PIN_DIGITAL_OUT, "motor IN2"},
+  {MOTOR_IN3,                      PIN_DIGITAL_OUT, "motor IN3"},
+  {MOTOR_IN4,                      PIN_DIGITAL_OUT, "motor IN4"},
+};
+static_assert(pins_unique(boardPins), "A GPIO is assigned twice");
+static_assert(pins_exist<Board>(boardPins), "A GPIO is reserved or missing on this board");
+static_assert(pins_can_drive<Board>(boardPins), "An output is assigned to an input-only GPIO");
+static_assert(pins_analog_capable<Board>(boardPins), "An analog input is not on ADC1 (ADC2 is unusable with WiFi)");
+
 // Add with other global variables
-unsigned long lastUltrasonicCheck = 0;
 unsigned long ledTurnOffTime = 0;
 
 // Add after other #defines
-#define ACCIDENT_LEVEL_1 1    // Ultrasonic + Vibration
-#define ACCIDENT_LEVEL_2 2    // All sensors triggered
 #define PHONE_NUMBER_2 "+233557043125"  // Family member's number
 
+// SMS recipients in order; a number listed twice is only texted once
+const char *const emergencyContacts[] = {EMERGENCY_PHONE_NUMBER, PHONE_NUMBER_2};
+#define EMERGENCY_CONTACT_COUNT (sizeof(emergencyContacts) / sizeof(emergencyContacts[0]))
+// Alert timeline channels: one SMS per contact, then the call and the backend event
+#define ALERT_CHANNEL_CALL EMERGENCY_CONTACT_COUNT
+#define ALERT_CHANNEL_BACKEND (EMERGENCY_CONTACT_COUNT + 1)
+#define ALERT_CHANNEL_COUNT (EMERGENCY_CONTACT_COUNT + 2)
+static_assert(ALERT_CHANNEL_COUNT <= ALERT_MAX_CHANNELS, "Too many emergency contacts");
+
 // Add after other global variables
-int currentAccidentLevel = 0;
-bool callSent = false;
+int currentAccidentLevel = 0;   // Level confirmed by the last check_accident()
 
 // Add after other global variables
 unsigned long lastMotorStatusUpdate = 0;
 unsigned long motorMessageDuration = 1000;  // Show motor status for 1 second
 bool motorStatusDisplayed = false;
 
-// Add after other global variables
-unsigned long lastUltrasonicRead = 0;
-unsigned long lastSensorRead = 0;
-
 // Add after other global variables
 unsigned long lastValidReading = 0;
 int consecutiveMaxReadings = 0;
 
 // Add after global variables
-volatile unsigned long pulseStart = 0;
-volatile long currentDistance = 0;
-volatile bool newDistanceAvailable = false;
+EchoDemux<ULTRASONIC_MAX_SENSORS> echoDemux;
+long sensorDistance[ULTRASONIC_MAX_SENSORS];   // Last validated distance per sensor
 TaskHandle_t ultrasonicTaskHandle = NULL;
 
 // Add LCD display states
@@ -249,16 +502,8 @@ String currentLcdText = "";
 int pulseHistory[PULSE_HISTORY_SIZE] = {0};
 int pulseHistoryIndex = 0;
 
-// Add after other global definitions
-#define HISTORY_SIZE 20  // Store last 20 readings for each sensor
-struct SensorHistory {
-    long distance[HISTORY_SIZE];
-    int alcohol[HISTORY_SIZE];
-    float impact[HISTORY_SIZE];
-    int pulse[HISTORY_SIZE];
-    int vibration[HISTORY_SIZE];
-    int index;
-} sensorHistory = {{0}, {0}, {0}, {0}, {0}, 0};
+// Add after other global definitions (SensorHistory is in telemetry_payload.h)
+SensorHistory sensorHistory = {{0}, {0}, {0}, {0}, {0}, 0};
 
 // Add after other global variables
 unsigned int connectionFailCount = 0;
@@ -267,35 +512,273 @@ unsigned int connectionFailCount = 0;
 unsigned long startTime = 0;  // Track system uptime
 
 // Add after other global variables
-#define PULSE_DATA_POINTS 60  // Store 1 minute of data
-struct PulseData {
-    unsigned long timestamp;
-    int value;
-} pulseDataHistory[PULSE_DATA_POINTS];
+PulseData pulseDataHistory[PULSE_DATA_POINTS];
 int pulseDataIndex = 0;
+char backendPayload[TELEMETRY_PAYLOAD_MAX];   // Network task only
 
 HardwareSerial GSM(2); // Use UART2 for GSM
 LiquidCrystal_I2C lcd(LCD_ADDRESS, LCD_COLS, LCD_ROWS);
 Adafruit_MPU6050 mpu;
 sensors_event_t a, g, temp;
+bool imuTempValid = false;   // temp holds a real reading (control loop only)
+
+AlcoholPipeline alcoholPipeline(alcohol_config());   // Control loop only
+OrientationFilter orientationFilter(IMU_FILTER_BETA);
+VibrationAnalyzer<VIBRATION_WINDOW> vibrationAnalyzer(VIBRATION_SAMPLE_RATE, vibrationBandEdges);
+hw_timer_t *vibrationTimer = NULL;
+TaskHandle_t vibrationTaskHandle = NULL;
+SpscQueue<VibrationFeatures, VIBRATION_QUEUE_SIZE> vibrationQueue;
+std::atomic<uint32_t> vibrationMissedSamples(0);
+
+// Sensor snapshot handed from the control core to the network core
+struct TelemetrySample {
+  unsigned long timeMs;
+  int64_t captureMonoUs;         // esp_timer time of the reading, for the UTC stamp
+  VehicleState state;
+  float lat;
+  float lng;
+  bool gpsValid;
+  uint32_t satellites;
+  unsigned long pulseTimestamp;  // millis() of the last validated BPM reading
+};
+
+// Timestamped copy of the core vehicle readings, published once per control
+// loop. Tasks other than the control loop read it instead of vehicleState.
+struct VehicleSnapshot {
+  uint32_t timeUs;
+  float roll;
+  float pitch;
+  float impact;
+  int32_t distance;
+  int32_t alcoholLevel;
+  int32_t pulse;
+  float speed;
+};
+
+// LCD text queued by the control core, drawn by the network core
+struct LcdMessage {
+  char line1[LCD_COLS + 1];
+  char line2[LCD_COLS + 1];
+};
+
+// Small real-time frame for the WebSocket stream
+struct StreamFrame {
+  uint32_t captureUs;
+  int64_t captureMonoUs;
+  unsigned long captureMs;
+  VehicleState state;
+  float lat;
+  float lng;
+  bool gpsValid;
+};
+
+SpscQueue<TelemetrySample, TELEMETRY_QUEUE_SIZE> telemetryQueue;
+SeqLock<VehicleSnapshot> vehicleSnapshot;
+SpscQueue<TrackFix, TRACK_QUEUE_SIZE> trackQueue;
+std::atomic<uint32_t> snapshotReadRetries(0);
+SpscQueue<StreamFrame, STREAM_QUEUE_SIZE> streamQueue;
+TaskHandle_t streamTaskHandle = NULL;
+WebSocketsClient streamSocket;
+CoalescingSender<StreamFrame, STREAM_MAX_IN_FLIGHT> streamSender;
+LatencyWindow<64> streamSendToAck;      // Network round trip
+LatencyWindow<64> streamCaptureToAck;   // Sensor capture to acknowledgement
+std::atomic<uint8_t> streamRateHz(STREAM_RATE_HZ);
+bool streamConnected = false;
+SpscQueue<LcdMessage, LCD_QUEUE_SIZE> lcdQueue;
+TaskHandle_t networkTaskHandle = NULL;
+TelemetrySample latestTelemetry = {};   // Network core copy used by send_to_backend()
+
+// Fast-reconnect data from the last connection made by a full scan, kept in NVS
+struct WifiCache {
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t valid;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+};
+
+LinkManager wifiLink(WIFI_FAST_TIMEOUT, WIFI_SCAN_TIMEOUT, WIFI_BACKOFF_MIN, WIFI_BACKOFF_MAX);  // Network task only
+WifiCache wifiCache = {};
+Preferences wifiPrefs;
+std::atomic<uint8_t> wifiDisconnectReason(0);   // Written by the WiFi event task
+
+I2cScheduler<I2C_LEVELS, I2C_QUEUE_SIZE> i2cBus;
+TaskHandle_t i2cTaskHandle = NULL;
+uint32_t i2cClockHz = 0;                        // I2C task only (setup before it starts)
+LcdShadow<LCD_COLS, LCD_ROWS> lcdShadow;        // Network task only (setup before it starts)
+std::atomic<bool> lcdRedraw(false);             // Set by the I2C task when an LCD write failed
+uint32_t imuRequestTag = 0;
+std::atomic<uint32_t> imuReadTimeouts(0);
+
+// One time reference: the UTC an NMEA sentence reports and when its '$'
+// arrived, or the UTC an SNTP sync set and when it completed
+struct TimeObservation {
+  int64_t monoUs;
+  int64_t utcUs;
+};
+
+SpscQueue<TimeObservation, TIME_QUEUE_SIZE> gpsTimeQueue;    // Control core -> network task
+SpscQueue<TimeObservation, TIME_QUEUE_SIZE> sntpTimeQueue;   // lwIP task -> network task
+ClockDiscipline clockDiscipline(TIME_GPS_WINDOW, TIME_GPS_FRESH, TIME_STEP_THRESHOLD,
+                                TIME_GPS_UNCERTAINTY, TIME_SNTP_UNCERTAINTY,
+                                TIME_NMEA_LATENCY);          // Network task only
+// Written by the network task only. The stream task outranks it on
+// NETWORK_CORE and can preempt a write it would then never see finish, so
+// readers never retry: they take tryRead() and keep their last good model.
+SeqLock<ClockModel> deviceClock;
+
+// Trip recorder state, owned by the network task
+TrackSimplifier trackSimplifier(TRACK_TOLERANCE_M, TRACK_SPEED_TOLERANCE, TRACK_MAX_GAP);
+TrackSegmentWriter trackSegment;
+Preferences tripPrefs;
+bool tripStorageReady = false;
+uint32_t tripId = 0;                     // Active trip, 0 when not moving
+uint32_t tripLastMovingMs = 0;
+unsigned long tripSegmentStart = 0;
+String tripUploadPath;                   // Trip file being uploaded
+uint32_t tripUploadId = 0;
+uint32_t tripUploadOffset = 0;
+uint32_t tripUploadSegment = 0;
+unsigned long lastTripUpload = 0;
+
+struct TripStats {
+  uint32_t fixes;
+  uint32_t kept;
+  uint32_t bytesWritten;
+  uint32_t segmentsWritten;
+  uint32_t segmentsUploaded;
+  uint32_t uploadFailures;
+  uint64_t cycles;        // Simplifier time across all fixes
+} tripStats = {};
+unsigned long lastPulseTimestamp = 0;   // Written by measure_bpm() on the body sensor task
+
+// Result of one body sensor pass, handed to the control loop
+struct BodySensorReading {
+  bool seatbelt;
+  int pulse;
+  int lastStoredPulse;           // Newest entry of pulseHistory
+  unsigned long pulseTimestamp;  // millis() of the last validated BPM reading
+};
+
+SpscQueue<BodySensorReading, BODY_SENSOR_QUEUE_SIZE> bodySensorQueue;
+TaskHandle_t bodySensorTaskHandle = NULL;
+BodySensorReading bodyReading = {};     // Control core copy of the newest reading
+
+// Confirmed accident, handed from the control core to the Alert task
+struct AccidentEvent {
+  uint32_t detectUs;
+  unsigned long detectMs;
+  int level;
+  float lat;
+  float lng;
+  bool gpsValid;
+  float impactG;
+  float roll;
+  float pitch;
+  long distance;
+};
+
+// Steps of the GSM side of an alert, driven by the Alert task
+enum GsmAlertStep {
+  GSM_ALERT_IDLE,
+  GSM_ALERT_TEXT_MODE,    // AT+CMGF=1 sent
+  GSM_ALERT_SMS_PROMPT,   // AT+CMGS sent, waiting for the '>' prompt
+  GSM_ALERT_SMS_SENT,     // Message sent, waiting for +CMGS
+  GSM_ALERT_DIALLING,     // ATD sent
+  GSM_ALERT_IN_CALL,
+  GSM_ALERT_HANGUP        // ATH sent
+};
+
+SpscQueue<AccidentEvent, ALERT_QUEUE_SIZE> accidentQueue;
+AlertGate accidentGate(ACCIDENT_COOLDOWN);   // Control core only
+AlertTimeline alertTimeline;
+SeqLock<AlertReport> alertReport;            // Written by the Alert task; readers keep their last copy
+AccidentEvent activeAlert = {};              // Set by the Alert task before it wakes AlertPost
+std::atomic<bool> alertActive(false);        // Periodic uploads hold off while set
+std::atomic<uint32_t> preemptedUploads(0);
+TaskHandle_t alertTaskHandle = NULL;
+TaskHandle_t alertPostTaskHandle = NULL;
+GsmAlertStep gsmStep = GSM_ALERT_IDLE;
+unsigned long gsmStepStart = 0;
+size_t gsmContact = 0;
+int gsmAttempts = 0;
+String alertMessage;
+char gsmLine[64];
+size_t gsmLineLength = 0;
+
+// Stage budgets; while shedding, LCD refreshes, history uploads and debug logs are skipped
+DeadlineMonitor<DEADLINE_MAX_STAGES> deadlineMonitor(SENSOR_ERROR_THRESHOLD, RECOVERY_DELAY * 1000UL);
+int stageControlLoop = -1;
+int stageDistance = -1;
+int stageBodySensors = -1;
+int stageBackendPost = -1;
+std::atomic<uint32_t> shedLcdRefreshes(0);
+std::atomic<uint32_t> shedUploads(0);
+std::atomic<uint32_t> shedLogs(0);
+unsigned long lastTaskStatsReport = 0;
+
+// Busy time per core in microseconds, accumulated by the tasks pinned there
+std::atomic<uint32_t> coreBusyUs[2];
 
 // Function declarations
 void update_lcd_status(const String &line1, const String &line2);
 int measure_bpm(int pin, int measurement_time_sec = BPM_SAMPLE_TIME);
-int check_alcohol();
+void update_alcohol();
+const char *alcohol_state_name(uint8_t state);
 int get_average_alcohol();
 bool check_accident();
 void send_accident_alert();
 long measure_distance();
-void get_gps_data();
+void update_motion();
+void read_gps();
+void read_sensors();
+void refresh_lcd();
+void show_gps_position();
+void report_gps();
+void measure_distance_and_control_motors();
 void start_motor();
 void stop_motor();
 void set_motor_speed(int speed);
 bool detect_dangerous_conditions();
 void make_emergency_call();
+void alertTask(void *pvParameters);
+void alertPostTask(void *pvParameters);
 void ultrasonicTask(void *pvParameters);
-void IRAM_ATTR echoISR();
+void IRAM_ATTR echoISR(void *arg);
 void send_to_backend();
+void networkTask(void *pvParameters);
+void bodySensorTask(void *pvParameters);
+void init_deadlines();
+void end_task_stage(int stage);
+bool debug_log_enabled();
+void streamTask(void *pvParameters);
+void publish_stream_frame();
+void publish_vehicle_snapshot();
+void record_track_fix();
+void record_gps_time(int64_t sentenceStartUs);
+void init_time_service();
+void update_device_clock();
+const char *time_source_name(uint8_t source);
+void init_trips();
+void update_trip_recorder();
+void upload_trip_segment();
+bool read_vehicle_snapshot(VehicleSnapshot &snapshot);
+void update_orientation();
+bool read_imu();
+void flush_lcd();
+void update_vibration();
+void vibrationTask(void *pvParameters);
+void IRAM_ATTR vibrationTimerISR();
+#ifdef SAFEDRIVE_BENCH
+void run_benchmarks();
+#endif
+#if SAFEDRIVE_TRACE
+void init_trace();
+void flush_trace();
+void trace_vibration_window(const uint16_t *samples, uint32_t windowEndUs);
+#endif
 void suspendUltrasonicTask();
 bool send_sms_with_retry(const String &message, int maxRetries = 3);
 bool wait_for_gsm_response(const char* expected, unsigned long timeout);
@@ -303,18 +786,151 @@ void wait_for_seat_belt();
 bool init_mpu();
 void init_gps();
 
-void update_lcd_status(const String &line1, const String &line2) {
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print(line1);
-  lcd.setCursor(0, 1);
-  lcd.print(line2);
+// Control loop jobs: function, period (ms), phase (ms), CPU budget (us). The
+// phases keep the slower jobs off each other's ticks.
+using ControlSchedule = StaticSchedule<CONTROL_LOOP_INTERVAL,
+  PeriodicJob<update_motion, CONTROL_LOOP_INTERVAL, 0, 700>,
+  PeriodicJob<read_gps, CONTROL_LOOP_INTERVAL, 0, 150>,
+  PeriodicJob<publish_vehicle_snapshot, CONTROL_LOOP_INTERVAL, 0, 20>,
+  PeriodicJob<publish_stream_frame, CONTROL_LOOP_INTERVAL, 0, 80>,
+  PeriodicJob<measure_distance_and_control_motors, MOTOR_UPDATE_INTERVAL, 0, 300>,
+  PeriodicJob<read_sensors, SENSOR_UPDATE_INTERVAL, 5, 400>,
+  PeriodicJob<update_alcohol, ALCOHOL_SAMPLE_INTERVAL, 25, 80>,
+  PeriodicJob<refresh_lcd, SENSOR_UPDATE_INTERVAL, 10, 250>,
+  PeriodicJob<show_gps_position, GPS_DISPLAY_INTERVAL, 15, 250>,
+  PeriodicJob<report_gps, GPS_REPORT_INTERVAL, 20, 300>>;
+static_assert(ControlSchedule::worstTickBudgetUs() <= CONTROL_LOOP_BUDGET_US,
+              "Control jobs due in the same tick exceed the loop budget");
+static_assert(ControlSchedule::jobBudgetUs<measure_distance_and_control_motors>() > 0,
+              "The distance stage takes its deadline from the schedule table");
+
+// CPU budget of every task: time spent running per period, not blocked
+constexpr TaskBudget taskBudgets[] = {
+  // name               period (us)                            budget (us)      core
+  {"control",           CONTROL_LOOP_INTERVAL * 1000,          ControlSchedule::averageTickBudgetUs(), CONTROL_CORE},
+  {"ultrasonic",        ULTRASONIC_INTERVAL * 1000,            60,              CONTROL_CORE},
+  {"vibration sample",  1000000 / VIBRATION_SAMPLE_RATE,       30,              CONTROL_CORE},
+  {"vibration window",  VIBRATION_WINDOW * 1000000 / VIBRATION_SAMPLE_RATE, 3000, CONTROL_CORE},
+  {"body sensors",      BPM_WINDOW_SEC * 1000000 + SENSOR_UPDATE_INTERVAL * 1000, 40000, CONTROL_CORE},
+  {"network",           NETWORK_TASK_INTERVAL * 1000,          1500,            NETWORK_CORE},
+  {"backend post",      BACKEND_UPDATE_INTERVAL * 1000,        TLS_POST_CPU_US, NETWORK_CORE},
+  {"trip upload",       TRIP_UPLOAD_INTERVAL * 1000,           TLS_POST_CPU_US, NETWORK_CORE},
+  {"stream",            STREAM_TASK_INTERVAL * 1000,           250,             NETWORK_CORE},
+  {"alert",             ALERT_TASK_INTERVAL * 1000,            100,             NETWORK_CORE},
+  {"i2c",               CONTROL_LOOP_INTERVAL * 1000,          60,              CONTROL_CORE},
+};
+static_assert(core_load_permille(taskBudgets, CONTROL_CORE) <= SCHEDULE_CORE_LOAD_LIMIT,
+              "CONTROL_CORE is over-subscribed");
+static_assert(core_load_permille(taskBudgets, NETWORK_CORE) <= SCHEDULE_CORE_LOAD_LIMIT,
+              "NETWORK_CORE is over-subscribed");
+
+void draw_lcd(const String &line1, const String &line2) {
+  lcdShadow.set(0, line1.c_str());
+  lcdShadow.set(1, line2.c_str());
+  flush_lcd();
   currentLcdText = line1 + " | " + line2;  // Use separator for clearer display
-  Serial.println("[LCD] " + currentLcdText);  // Debug output
+  if (debug_log_enabled()) {
+    Serial.println("[LCD] " + currentLcdText);  // Debug output
+  }
+}
+
+void update_lcd_status(const String &line1, const String &line2) {
+  // Until the network task is running (setup), draw directly
+  if (networkTaskHandle == NULL || xTaskGetCurrentTaskHandle() == networkTaskHandle) {
+    draw_lcd(line1, line2);
+    return;
+  }
+
+  // Control core: queue the text, skipping repeats of the last queued message
+  static LcdMessage lastQueued = {};
+  LcdMessage msg = {};
+  strncpy(msg.line1, line1.c_str(), LCD_COLS);
+  strncpy(msg.line2, line2.c_str(), LCD_COLS);
+  if (strcmp(msg.line1, lastQueued.line1) == 0 && strcmp(msg.line2, lastQueued.line2) == 0) {
+    return;
+  }
+  if (lcdQueue.push(msg)) {
+    lastQueued = msg;
+  }
+}
+
+// The only Wire.begin(); the LCD and MPU drivers' own begin() calls find the bus already up
+void init_i2c() {
+  Wire.begin(I2C_SDA, I2C_SCL, I2C_LCD_CLOCK);
+  Wire.setTimeOut(I2C_TIMEOUT);
+  i2cClockHz = I2C_LCD_CLOCK;
+}
+
+// Runs one transaction on Wire; I2C task only, or setup before the task starts
+uint8_t i2c_execute(const I2cTransaction &txn, uint8_t *readData) {
+  if (txn.clockHz != i2cClockHz) {
+    Wire.setClock(txn.clockHz);
+    i2cClockHz = txn.clockHz;
+  }
+  Wire.beginTransmission(txn.address);
+  Wire.write(txn.data, txn.writeLength);
+  uint8_t error = Wire.endTransmission(txn.readLength == 0);  // Repeated start before a read
+  if (error == 0 && txn.readLength > 0) {
+    if (Wire.requestFrom(txn.address, (size_t)txn.readLength) != txn.readLength) {
+      return 4;  // Same code as endTransmission()'s "other error"
+    }
+    Wire.readBytes(readData, txn.readLength);
+  }
+  return error;
+}
+
+bool i2c_submit(size_t level, I2cTransaction &txn) {
+  if (!i2cBus.submit(level, txn, micros())) return false;
+  xTaskNotifyGive(i2cTaskHandle);
+  return true;
+}
+
+// Owns Wire once started: runs the queued transactions, highest priority first
+void i2cTask(void *pvParameters) {
+  I2cTransaction txn;
+  size_t level;
+  uint8_t readData[I2C_MAX_READ];
+  esp_task_wdt_add(NULL);
+
+  while (1) {
+    while (i2cBus.next(txn, level)) {
+      uint32_t start = micros();
+      uint8_t error = i2c_execute(txn, readData);
+      i2cBus.completed(level, txn, start, micros(), error, readData);
+      if (error && level == I2C_LEVEL_DISPLAY) {
+        lcdRedraw.store(true, std::memory_order_relaxed);
+      }
+      if (txn.notify) {
+        xTaskNotifyGive((TaskHandle_t)txn.notify);
+      }
+    }
+    esp_task_wdt_reset();
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+  }
+}
+
+// Sends the LCD cells that changed; what doesn't fit in the queue goes on a later pass
+void flush_lcd() {
+  if (lcdRedraw.exchange(false, std::memory_order_relaxed)) {
+    lcdShadow.invalidate();
+  }
+  I2cTransaction txn = {};
+  txn.clockHz = I2C_LCD_CLOCK;
+  txn.address = LCD_ADDRESS;
+  size_t row, col;
+  while (true) {
+    txn.writeLength = lcdShadow.nextUpdate(txn.data, row, col);
+    if (txn.writeLength == 0) break;
+    if (i2cTaskHandle == NULL) {
+      i2c_execute(txn, NULL);
+    } else if (!i2c_submit(I2C_LEVEL_DISPLAY, txn)) {
+      break;
+    }
+    lcdShadow.commit(row, col);
+  }
 }
 
 void init_lcd() {
-  Wire.begin(I2C_SDA, I2C_SCL);
   lcd.init();
   lcd.backlight();
   lcd.clear();
@@ -345,7 +961,7 @@ bool init_mpu() {
   }
   mpu.setAccelerometerRange(MPU6050_RANGE_8_G);
   mpu.setGyroRange(MPU6050_RANGE_500_DEG);
-  mpu.setFilterBandwidth(MPU6050_BAND_21_HZ);
+  mpu.setFilterBandwidth(MPU6050_BAND_44_HZ);  // Below Nyquist for the 200 Hz control loop
   return true;
 }
 
@@ -485,34 +1101,91 @@ void wait_for_network() {
   delay(2000);
 }
 
-void connect_wifi() {
-  update_lcd_status("WiFi Connecting", "Please wait...");
-  Serial.println("[WiFi] Connecting to WiFi...");
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-  int attempts = 0;
-  digitalWrite(WIFI_LED_PIN, LOW);  // LED off while attempting to connect
-  
-  while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-    delay(500);
-    Serial.print(".");
-    attempts++;
+void on_wifi_disconnected(WiFiEvent_t event, WiFiEventInfo_t info) {
+  wifiDisconnectReason.store(info.wifi_sta_disconnected.reason, std::memory_order_relaxed);
+}
+
+// Connection attempts are made by update_wifi() on the network task
+void init_wifi() {
+  WiFi.persistent(false);         // wifiCache replaces the SDK's own copy in flash
+  WiFi.setAutoReconnect(false);   // update_wifi() decides when to retry
+  WiFi.mode(WIFI_STA);
+  WiFi.onEvent(on_wifi_disconnected, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  digitalWrite(WIFI_LED_PIN, LOW);  // LED off until connected
+
+  wifiPrefs.begin("wifi", false);
+  if (wifiPrefs.getBytes("cache", &wifiCache, sizeof(wifiCache)) != sizeof(wifiCache)) {
+    wifiCache = {};
   }
-  
-  if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("[WiFi] Connected successfully");
-    Serial.print("[WiFi] IP address: ");
-    Serial.println(WiFi.localIP());
+  wifiLink.seed((uint32_t)ESP.getEfuseMac());
+  Serial.printf("[WiFi] Connecting to %s in the background%s\n", WIFI_SSID,
+                wifiCache.valid ? ", fast reconnect cached" : "");
+}
+
+// Refreshes the fast-reconnect cache after a scan connection; only written when it changed
+void save_wifi_cache() {
+  WifiCache cache = {};
+  memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+  cache.channel = WiFi.channel();
+  cache.valid = 1;
+  cache.ip = WiFi.localIP();
+  cache.gateway = WiFi.gatewayIP();
+  cache.subnet = WiFi.subnetMask();
+  cache.dns = WiFi.dnsIP();
+  if (memcmp(&cache, &wifiCache, sizeof(cache)) == 0) return;
+  wifiCache = cache;
+  wifiPrefs.putBytes("cache", &wifiCache, sizeof(wifiCache));
+}
+
+// Network task, every pass: advances the link state machine and carries out its action
+void update_wifi() {
+  const bool wasUp = wifiLink.up();
+  const LinkAction action = wifiLink.update(millis(), WiFi.status() == WL_CONNECTED, wifiCache.valid);
+
+  switch (action) {
+    case LINK_ACTION_CONNECT_FAST:
+#if WIFI_CACHE_IP
+      WiFi.config(IPAddress(wifiCache.ip), IPAddress(wifiCache.gateway),
+                  IPAddress(wifiCache.subnet), IPAddress(wifiCache.dns));
+#endif
+      WiFi.begin(WIFI_SSID, WIFI_PASSWORD, wifiCache.channel, wifiCache.bssid);
+      break;
+    case LINK_ACTION_CONNECT_SCAN:
+      WiFi.disconnect();
+      WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));  // Back to DHCP
+      WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+      break;
+    case LINK_ACTION_ABORT:
+      WiFi.disconnect();
+      if (debug_log_enabled()) {
+        Serial.printf("[WiFi] Connection failed (reason %u), retrying in %u ms\n",
+                      wifiDisconnectReason.load(std::memory_order_relaxed), wifiLink.retryDelayMs());
+      }
+      break;
+    case LINK_ACTION_NONE:
+      break;
+  }
+
+  if (!wasUp && wifiLink.up()) {
     digitalWrite(WIFI_LED_PIN, HIGH);  // Solid LED when connected
-    update_lcd_status("WiFi Connected", WiFi.localIP().toString());
-  } else {
-    Serial.println("[WiFi] Connection failed!");
-    digitalWrite(WIFI_LED_PIN, LOW);  // LED off if connection fails
+    Serial.printf("[WiFi] Connected in %u ms (%s), IP %s\n", wifiLink.lastAssociateMs(),
+                  wifiLink.lastConnectWasScan() ? "scan" : "fast", WiFi.localIP().toString().c_str());
+    if (wifiLink.lastConnectWasScan()) {
+      save_wifi_cache();
+    }
+  } else if (wasUp && !wifiLink.up()) {
+    digitalWrite(WIFI_LED_PIN, LOW);
+    Serial.printf("[WiFi] Link lost (reason %u), reconnecting\n",
+                  wifiDisconnectReason.load(std::memory_order_relaxed));
   }
 }
 
 void init_gps() {
     // GPS Serial port with proper settings
     Serial1.begin(9600, SERIAL_8N1, GPS_TX_PIN, GPS_RX_PIN);
+    // Hand over every byte as it arrives instead of after 120 bytes or an
+    // idle timeout, so read_gps() stamps each '$' within a control tick
+    Serial1.setRxFIFOFull(1);
     pinMode(GPS_RX_PIN, INPUT_PULLUP);
     pinMode(GPS_TX_PIN, OUTPUT);
 
@@ -537,8 +1210,13 @@ void init_gps() {
 }
 
 void setup() {
+#if SAFEDRIVE_TRACE == 1
+  Serial.begin(TRACE_SERIAL_BAUD);
+#else
   Serial.begin(115200);
+#endif
   startTime = millis(); // Track system uptime
+  init_i2c();
   init_lcd();
   
   // Initialize pins with status updates
@@ -592,40 +1270,60 @@ void setup() {
   delay(100);  // Give motor time to start
 
   // Continue with remaining setup
-  connect_wifi();
+  init_wifi();
+  init_time_service();
 
   // GPS Serial port - update baud rate and enable internal pullups
   init_gps();
 
-  Wire.begin(I2C_SDA, I2C_SCL);
   if (!init_mpu()) {
     update_lcd_status("MPU6050 Error", "Check Connection");
     delay(2000);
   }
 
+  // From here on only the I2C task touches Wire
+  BaseType_t taskCreated = xTaskCreatePinnedToCore(
+    i2cTask,
+    "I2C",
+    I2C_TASK_STACK,
+    NULL,
+    I2C_TASK_PRIORITY,
+    &i2cTaskHandle,
+    CONTROL_CORE
+  );
+
+  if (taskCreated != pdPASS || i2cTaskHandle == NULL) {
+    Serial.println("Failed to create I2C task!");
+    ESP.restart();
+  }
+
   // Setup PWM for both motors
   ledcSetup(MOTOR_PWM_CHANNEL_1, MOTOR_PWM_FREQ, MOTOR_PWM_RESOLUTION);
   ledcSetup(MOTOR_PWM_CHANNEL_2, MOTOR_PWM_FREQ, MOTOR_PWM_RESOLUTION);
   ledcAttachPin(MOTOR_IN1, MOTOR_PWM_CHANNEL_1);
   ledcAttachPin(MOTOR_IN3, MOTOR_PWM_CHANNEL_2);
 
-  // Setup ultrasonic interrupt
-  pinMode(ULTRASONIC_TRIG, OUTPUT);
-  pinMode(ULTRASONIC_ECHO, INPUT);
-  attachInterrupt(digitalPinToInterrupt(ULTRASONIC_ECHO), echoISR, CHANGE);
+  // Setup ultrasonic interrupts: one shared ISR, told which sensor fired
+  for (size_t i = 0; i < ULTRASONIC_SENSOR_COUNT; i++) {
+    pinMode(ultrasonicSensors[i].trigPin, OUTPUT);
+    digitalWrite(ultrasonicSensors[i].trigPin, LOW);
+    pinMode(ultrasonicSensors[i].echoPin, INPUT);
+    sensorDistance[i] = ULTRASONIC_MAX_DIST;
+    attachInterruptArg(digitalPinToInterrupt(ultrasonicSensors[i].echoPin), echoISR, (void *)i, CHANGE);
+  }
 
   // Pulse sensor pin setup
   pinMode(PULSE_PIN, INPUT);
 
   // Create ultrasonic task with error checking
-  BaseType_t taskCreated = xTaskCreatePinnedToCore(
+  taskCreated = xTaskCreatePinnedToCore(
     ultrasonicTask,
     "Ultrasonic",
     4096,
     NULL,
     3,
     &ultrasonicTaskHandle,
-    1
+    CONTROL_CORE
   );
 
   if (taskCreated != pdPASS || ultrasonicTaskHandle == NULL) {
@@ -634,38 +1332,1237 @@ void setup() {
     ESP.restart();
   }
 
-  if (WiFi.status() == WL_CONNECTED) {
-    http.setReuse(true);  // Enable connection reuse
-    Serial.println("[Backend] HTTP client initialized");
+#if SAFEDRIVE_TRACE
+  init_trace();
+#endif
+
+  // Vibration sampling task, paced by a hardware timer
+  taskCreated = xTaskCreatePinnedToCore(
+    vibrationTask,
+    "Vibration",
+    4096,
+    NULL,
+    VIBRATION_TASK_PRIORITY,
+    &vibrationTaskHandle,
+    CONTROL_CORE
+  );
+
+  if (taskCreated != pdPASS || vibrationTaskHandle == NULL) {
+    Serial.println("Failed to create vibration task!");
+    ESP.restart();
   }
 
+  vibrationTimer = timerBegin(VIBRATION_TIMER, 80, true);  // 1 MHz timer clock
+  timerAttachInterrupt(vibrationTimer, &vibrationTimerISR, true);
+  timerAlarmWrite(vibrationTimer, 1000000 / VIBRATION_SAMPLE_RATE, true);
+  timerAlarmEnable(vibrationTimer);
+
+  http.setReuse(true);  // Enable connection reuse
+
   init_vehicle_state();  // Initialize vehicle state
+  init_deadlines();
+  init_trips();
+
+#ifdef SAFEDRIVE_BENCH
+  run_benchmarks();
+#endif
+
+  // Networking, logging and the LCD move to the other core from here on
+  taskCreated = xTaskCreatePinnedToCore(
+    networkTask,
+    "Network",
+    NETWORK_TASK_STACK,
+    NULL,
+    NETWORK_TASK_PRIORITY,
+    &networkTaskHandle,
+    NETWORK_CORE
+  );
+
+  if (taskCreated != pdPASS || networkTaskHandle == NULL) {
+    Serial.println("Failed to create network task!");
+    ESP.restart();
+  }
+
+  taskCreated = xTaskCreatePinnedToCore(
+    streamTask,
+    "Stream",
+    STREAM_TASK_STACK,
+    NULL,
+    STREAM_TASK_PRIORITY,
+    &streamTaskHandle,
+    NETWORK_CORE
+  );
+
+  if (taskCreated != pdPASS || streamTaskHandle == NULL) {
+    Serial.println("Failed to create stream task!");
+    ESP.restart();
+  }
+
+  taskCreated = xTaskCreatePinnedToCore(
+    bodySensorTask,
+    "BodySensors",
+    BODY_SENSOR_TASK_STACK,
+    NULL,
+    BODY_SENSOR_TASK_PRIORITY,
+    &bodySensorTaskHandle,
+    CONTROL_CORE
+  );
+
+  if (taskCreated != pdPASS || bodySensorTaskHandle == NULL) {
+    Serial.println("Failed to create body sensor task!");
+    ESP.restart();
+  }
+
+  // Created up front so raising an alert never allocates
+  taskCreated = xTaskCreatePinnedToCore(
+    alertPostTask,
+    "AlertPost",
+    ALERT_POST_TASK_STACK,
+    NULL,
+    ALERT_POST_TASK_PRIORITY,
+    &alertPostTaskHandle,
+    NETWORK_CORE
+  );
+
+  if (taskCreated != pdPASS || alertPostTaskHandle == NULL) {
+    Serial.println("Failed to create alert post task!");
+    ESP.restart();
+  }
+
+  taskCreated = xTaskCreatePinnedToCore(
+    alertTask,
+    "Alert",
+    ALERT_TASK_STACK,
+    NULL,
+    ALERT_TASK_PRIORITY,
+    &alertTaskHandle,
+    NETWORK_CORE
+  );
+
+  if (taskCreated != pdPASS || alertTaskHandle == NULL) {
+    Serial.println("Failed to create alert task!");
+    ESP.restart();
+  }
+
+  // The control loop is watched from here on; setup itself can take longer
+  esp_task_wdt_add(NULL);
+}
+
+// Registers the stage budgets and arms the task watchdog, before any task starts
+void init_deadlines() {
+  stageControlLoop = deadlineMonitor.add("control", CONTROL_LOOP_BUDGET_US, true);
+  // Held to the budget the schedule table declares for the job
+  stageDistance = deadlineMonitor.add("distance",
+      ControlSchedule::jobBudgetUs<measure_distance_and_control_motors>(), true);
+  stageBodySensors = deadlineMonitor.add("body", BODY_SENSOR_BUDGET_US, false);
+  stageBackendPost = deadlineMonitor.add("backend", BACKEND_POST_BUDGET_US, false);
+  esp_task_wdt_init(SYSTEM_WATCHDOG_TIMEOUT / 1000, true);
+}
+
+// Ends a task's top-level stage and feeds the watchdog on behalf of that task
+void end_task_stage(int stage) {
+  deadlineMonitor.end(stage, micros());
+  esp_task_wdt_reset();
+}
+
+// Debug logging is the first thing dropped while the control path is over budget
+bool debug_log_enabled() {
+  if (!deadlineMonitor.shedding()) return true;
+  shedLogs.fetch_add(1, std::memory_order_relaxed);
+  return false;
 }
 
+// Control job, every MOTOR_UPDATE_INTERVAL. The one place the echo slots are
+// read; read_sensors() reports the distance taken here.
 void measure_distance_and_control_motors() {
-  static unsigned long lastCheck = 0;
-  unsigned long now = millis();
-  
-  if (now - lastCheck >= MOTOR_RESPONSE_DELAY) {
-    long distance = measure_distance();
-    lastCheck = now;
-    
-    if (distance <= EMERGENCY_DISTANCE) {
+  deadlineMonitor.begin(stageDistance, micros());
+  static bool emergencyStopped = false;
+  long distance = measure_distance();
+  vehicleState.distance = distance;
+
+  if (distance <= EMERGENCY_DISTANCE) {
+    // Stop once per emergency; the distance follows once the "Stopped" screen times out
+    if (!emergencyStopped) {
       stop_motor();
+    } else if (currentLcdState != LCD_STATE_ENGINE) {
       update_lcd_status("EMERGENCY!", String(distance) + "cm");
-    } else if (distance <= WARNING_DISTANCE) {
-      int speed = map(distance, EMERGENCY_DISTANCE, WARNING_DISTANCE, 0, 255);
-      set_motor_speed(speed);
-      update_lcd_status("Slowing", String(distance) + "cm");
-    } else {
-      set_motor_speed(255);
     }
+  } else if (distance <= WARNING_DISTANCE) {
+    int speed = motor_speed_for_distance(distance);
+    set_motor_speed(speed);
+    update_lcd_status("Slowing", String(distance) + "cm");
+  } else {
+    set_motor_speed(255);
   }
+  emergencyStopped = distance <= EMERGENCY_DISTANCE;
+  deadlineMonitor.end(stageDistance, micros());
 }
 
+// loop() is the control task: it runs on CONTROL_CORE at a fixed period,
+// runs the jobs of ControlSchedule that are due and only ever hands data to
+// the network core through the SPSC queues
 void loop() {
-  measure_distance_and_control_motors();  // Check distance and control motors
-  get_gps_data();  // Continue with other sensor readings
+  static TickType_t lastWake = xTaskGetTickCount();
+  static uint32_t tick = 0;
+  uint32_t busyStart = micros();
+  deadlineMonitor.begin(stageControlLoop, busyStart);
+
+  ControlSchedule::run(tick++);
+
+  end_task_stage(stageControlLoop);
+  coreBusyUs[CONTROL_CORE].fetch_add(micros() - busyStart, std::memory_order_relaxed);
+  vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(CONTROL_LOOP_INTERVAL));
+}
+
+// Consumer side of telemetryQueue: keeps the history arrays on the network core
+void record_telemetry_sample(const TelemetrySample &sample) {
+  static unsigned long lastRecordedPulse = 0;
+  const VehicleState &state = sample.state;
+
+  // Store in history with bounds checking
+  if (state.distance > 0 && state.distance <= ULTRASONIC_MAX_DIST) {
+    sensorHistory.distance[sensorHistory.index] = state.distance;
+  }
+  sensorHistory.alcohol[sensorHistory.index] = state.alcoholLevel;
+  sensorHistory.impact[sensorHistory.index] = state.impact;
+  sensorHistory.pulse[sensorHistory.index] = state.pulse;
+  sensorHistory.vibration[sensorHistory.index] = state.vibration;
+  sensorHistory.index = (sensorHistory.index + 1) % HISTORY_SIZE;
+
+  // Store validated pulse data with timestamp
+  if (sample.pulseTimestamp != 0 && sample.pulseTimestamp != lastRecordedPulse) {
+    lastRecordedPulse = sample.pulseTimestamp;
+    pulseDataHistory[pulseDataIndex].timestamp = sample.pulseTimestamp;
+    pulseDataHistory[pulseDataIndex].value = state.pulse;
+    pulseDataIndex = (pulseDataIndex + 1) % PULSE_DATA_POINTS;
+  }
+
+  latestTelemetry = sample;
+
+  // Debug output
+  if (!debug_log_enabled()) return;
+  Serial.printf("Sensor Update - D:%ld A:%d I:%.2f P:%d V:%d (rms %.0f) S:%s\n",
+               state.distance, state.alcoholLevel,
+               state.impact, state.pulse,
+               state.vibration, state.vibrationRms, state.seatbelt ? "ON" : "OFF");
+}
+
+void report_task_stats() {
+  static unsigned long lastReport = 0;
+  unsigned long now = millis();
+  unsigned long elapsedUs = (now - lastReport) * 1000UL;
+  lastReport = now;
+  if (elapsedUs == 0) return;
+
+  uint32_t control = coreBusyUs[CONTROL_CORE].exchange(0, std::memory_order_relaxed);
+  uint32_t network = coreBusyUs[NETWORK_CORE].exchange(0, std::memory_order_relaxed);
+  Serial.printf("[TASKS] Core%d (control): %.1f%% | Core%d (network): %.1f%%\n",
+                CONTROL_CORE, control * 100.0 / elapsedUs,
+                NETWORK_CORE, network * 100.0 / elapsedUs);
+  Serial.printf("[TASKS] Telemetry queue: high-water %u/%u, dropped %u | LCD queue: high-water %u/%u, dropped %u\n",
+                telemetryQueue.highWater(), (unsigned)telemetryQueue.capacity(), telemetryQueue.dropped(),
+                lcdQueue.highWater(), (unsigned)lcdQueue.capacity(), lcdQueue.dropped());
+  Serial.printf("[TASKS] Vehicle snapshot: %u writes, %u reader retries\n",
+                vehicleSnapshot.sequence() / 2, snapshotReadRetries.load(std::memory_order_relaxed));
+  Serial.printf("[TASKS] Vibration queue: high-water %u/%u, dropped %u | missed samples %u\n",
+                vibrationQueue.highWater(), (unsigned)vibrationQueue.capacity(), vibrationQueue.dropped(),
+                vibrationMissedSamples.load(std::memory_order_relaxed));
+#if SAFEDRIVE_TRACE
+  Serial.printf("[TRACE] %u bytes written | control queue high-water %u, dropped %u | vibration queue high-water %u, dropped %u | body queue high-water %u, dropped %u\n",
+                traceBytesWritten, traceQueue.highWater(), traceQueue.dropped(),
+                traceVibrationQueue.highWater(), traceVibrationQueue.dropped(),
+                traceBodyQueue.highWater(), traceBodyQueue.dropped());
+#endif
+  static uint32_t lastEchoes = 0;
+  uint32_t echoes = echoDemux.echoes();
+  Serial.printf("[ULTRASONIC] %u sensors in %u slots: %.1f echoes/s | timeouts %u, busy skips %u, ignored edges %u\n",
+                (unsigned)ULTRASONIC_SENSOR_COUNT,
+                ultrasonic_slot_count(ultrasonicSensors, ULTRASONIC_SENSOR_COUNT),
+                (echoes - lastEchoes) * 1000000.0 / elapsedUs,
+                echoDemux.timeouts(), echoDemux.busySkips(), echoDemux.ignored());
+  lastEchoes = echoes;
+  for (size_t i = 0; i < ULTRASONIC_SENSOR_COUNT; i++) {
+    Serial.printf("[ULTRASONIC]   %s: %ld cm, %u echoes superseded before a read\n",
+                  ultrasonicSensors[i].name, sensorDistance[i], echoDemux.superseded(i));
+  }
+  Serial.printf("[TRIP] %u fixes, %u kept, %u bytes in %u segments (%.1fx), %.0f cycles/fix | uploaded %u, failed %u\n",
+                tripStats.fixes, tripStats.kept, tripStats.bytesWritten, tripStats.segmentsWritten,
+                tripStats.bytesWritten ? tripStats.fixes * 14.0 / tripStats.bytesWritten : 0.0,
+                tripStats.fixes ? (double)tripStats.cycles / tripStats.fixes : 0.0,
+                tripStats.segmentsUploaded, tripStats.uploadFailures);
+  static AlertReport lastAlert = {};   // Kept when the Alert task is mid-write
+  alertReport.tryRead(lastAlert);
+  Serial.printf("[ALERT] %u raised, %u suppressed by cooldown | preempted uploads %u | queue dropped %u\n",
+                lastAlert.count, accidentGate.suppressed(),
+                preemptedUploads.load(std::memory_order_relaxed), accidentQueue.dropped());
+  I2cLevelReport imu = i2cBus.takeStats(I2C_LEVEL_IMU);
+  I2cLevelReport display = i2cBus.takeStats(I2C_LEVEL_DISPLAY);
+  Serial.printf("[I2C] Bus %.1f%% busy (IMU %.1f%%, LCD %.1f%%) | IMU: %u reads, latency mean %u us, max %u us,"
+                " queued behind the LCD up to %u us, %u errors, %u timeouts | LCD: %u writes, %u errors,"
+                " queue high-water %u/%u\n",
+                (imu.busyUs + display.busyUs) * 100.0 / elapsedUs,
+                imu.busyUs * 100.0 / elapsedUs, display.busyUs * 100.0 / elapsedUs,
+                imu.transactions, imu.meanLatencyUs, imu.maxLatencyUs, imu.maxWaitUs, imu.errors,
+                imuReadTimeouts.load(std::memory_order_relaxed),
+                display.transactions, display.errors,
+                i2cBus.queue(I2C_LEVEL_DISPLAY).highWater(), (unsigned)i2cBus.queue(I2C_LEVEL_DISPLAY).capacity());
+  const LinkStats &link = wifiLink.stats();
+  Serial.printf("[WiFi] Up %.1f%% | %u drops, %u reconnects: last %u ms, max %u ms, mean %u ms | fast %u/%u (mean %u ms), scan %u/%u (mean %u ms)\n",
+                wifiLink.upPermille() / 10.0, link.drops, link.reconnects, link.lastOutageMs, link.maxOutageMs,
+                link.reconnects ? (uint32_t)(link.totalOutageMs / link.reconnects) : 0,
+                link.fastConnects, link.fastAttempts,
+                link.fastConnects ? (uint32_t)(link.fastAssociateMs / link.fastConnects) : 0,
+                link.scanConnects, link.scanAttempts,
+                link.scanConnects ? (uint32_t)(link.scanAssociateMs / link.scanConnects) : 0);
+  const ClockModel &clock = clockDiscipline.model();
+  Serial.printf("[TIME] %s, drift %.2f ppm, synced %lld s ago, uncertainty %u us | last residual %lld us, %u references, %u steps, %u SNTP syncs ignored | GPS queue dropped %u\n",
+                time_source_name(clock.valid ? clock.source : TIME_SOURCE_NONE), clock.driftPpb / 1000.0,
+                clock.valid ? (long long)((esp_timer_get_time() - clock.syncMonoUs) / 1000000) : -1LL,
+                clock.uncertaintyUs, (long long)clockDiscipline.lastResidualUs(),
+                clockDiscipline.references(), clockDiscipline.steps(), clockDiscipline.sntpIgnored(),
+                gpsTimeQueue.dropped());
+  for (size_t i = 0; i < deadlineMonitor.stageCount(); i++) {
+    const DeadlineStageStats &stage = deadlineMonitor.stage(i);
+    Serial.printf("[DEADLINE] %s: runs %u, misses %u, max %u us (budget %u us)\n",
+                  stage.name, stage.runs.load(std::memory_order_relaxed),
+                  stage.misses.load(std::memory_order_relaxed),
+                  stage.maxUs.load(std::memory_order_relaxed), stage.budgetUs);
+  }
+  Serial.printf("[DEADLINE] Shedding %s, %u shed events | skipped LCD refreshes %u, uploads %u, logs %u\n",
+                deadlineMonitor.shedding() ? "ON" : "off", deadlineMonitor.shedEvents(),
+                shedLcdRefreshes.load(std::memory_order_relaxed),
+                shedUploads.load(std::memory_order_relaxed),
+                shedLogs.load(std::memory_order_relaxed));
+}
+
+// Writer side of vehicleSnapshot, called once per control loop
+void publish_vehicle_snapshot() {
+  VehicleSnapshot snapshot;
+  snapshot.timeUs = micros();
+  snapshot.roll = vehicleState.roll;
+  snapshot.pitch = vehicleState.pitch;
+  snapshot.impact = vehicleState.impact;
+  snapshot.distance = vehicleState.distance;
+  snapshot.alcoholLevel = vehicleState.alcoholLevel;
+  snapshot.pulse = vehicleState.pulse;
+  snapshot.speed = vehicleState.speed;
+  vehicleSnapshot.write(snapshot);
+}
+
+// Consistent copy for any other task. The writer is the control loop on the
+// other core, so retrying is safe, but bounded all the same; false when no
+// attempt succeeded or the control loop has not published yet.
+bool read_vehicle_snapshot(VehicleSnapshot &snapshot) {
+  for (int attempt = 0; attempt < SNAPSHOT_READ_ATTEMPTS; attempt++) {
+    if (vehicleSnapshot.tryRead(snapshot)) return vehicleSnapshot.sequence() != 0;
+    snapshotReadRetries.fetch_add(1, std::memory_order_relaxed);
+  }
+  return false;
+}
+
+// Producer side of streamQueue, called every control loop
+void publish_stream_frame() {
+  static unsigned long lastFrame = 0;
+  unsigned long now = millis();
+  uint8_t rate = streamRateHz.load(std::memory_order_relaxed);
+  if (now - lastFrame < 1000UL / rate) return;
+  lastFrame = now;
+
+  StreamFrame frame;
+  frame.captureUs = micros();
+  frame.captureMonoUs = esp_timer_get_time();
+  frame.captureMs = now;
+  frame.state = vehicleState;
+  frame.lat = lat;
+  frame.lng = lng;
+  frame.gpsValid = gps.location.isValid();
+  streamQueue.push(frame);
+}
+
+void send_stream_frame(const StreamFrame &frame, uint32_t seq) {
+  static DynamicJsonDocument frameDoc(512);
+  char buffer[512];
+  const VehicleState &state = frame.state;
+
+  frameDoc.clear();
+  frameDoc["t"] = "sensor";
+  frameDoc["seq"] = seq;
+  frameDoc["captured_ms"] = frame.captureMs;
+  // Capture and send times in UTC, so the dashboard can split the pipeline
+  // latency into device and network parts
+  static ClockModel clock = {};   // Last good model, kept while a write is in progress
+  deviceClock.tryRead(clock);
+  if (clock.valid) {
+    frameDoc["utc_us"] = clock_to_utc(clock, frame.captureMonoUs);
+    frameDoc["sent_utc_us"] = clock_to_utc(clock, esp_timer_get_time());
+    frameDoc["clock_uncertainty_us"] = clock.uncertaintyUs;
+  }
+  frameDoc["alcohol"] = state.alcoholLevel;
+  frameDoc["vibration"] = state.vibration;
+  frameDoc["vibration_rms"] = state.vibrationRms;
+  frameDoc["road_condition"] = state.roadCondition;
+  frameDoc["distance"] = state.distance;
+  frameDoc["seatbelt"] = state.seatbelt;
+  frameDoc["impact"] = state.impact;
+  frameDoc["pulse"] = state.pulse;
+  frameDoc["roll"] = state.roll;
+  frameDoc["pitch"] = state.pitch;
+  frameDoc["gps_valid"] = frame.gpsValid;
+  if (frame.gpsValid) {
+    frameDoc["lat"] = frame.lat;
+    frameDoc["lng"] = frame.lng;
+  }
+
+  size_t length = serializeJson(frameDoc, buffer, sizeof(buffer));
+  streamSocket.sendTXT(buffer, length);
+}
+
+// Server messages: acknowledgements for our frames and commands
+void handle_stream_message(const uint8_t *payload, size_t length) {
+  DynamicJsonDocument doc(256);
+  if (deserializeJson(doc, payload, length)) {
+    Serial.println("[STREAM] Ignoring malformed message");
+    return;
+  }
+
+  const char *type = doc["t"] | "";
+  if (strcmp(type, "ack") == 0) {
+    uint32_t sendToAck, captureToAck;
+    if (streamSender.ack(doc["seq"] | 0UL, micros(), sendToAck, captureToAck)) {
+      streamSendToAck.record(sendToAck);
+      streamCaptureToAck.record(captureToAck);
+    }
+    return;
+  }
+
+  if (strcmp(type, "cmd") == 0) {
+    const char *cmd = doc["cmd"] | "";
+    bool ok = true;
+    DynamicJsonDocument reply(192);
+    reply["t"] = "cmd_ack";
+    reply["id"] = doc["id"] | 0;
+
+    if (strcmp(cmd, "rate") == 0) {
+      int hz = doc["hz"] | STREAM_RATE_HZ;
+      ok = hz >= 1 && hz <= 10;
+      if (ok) streamRateHz.store(hz, std::memory_order_relaxed);
+    } else if (strcmp(cmd, "ping") == 0) {
+      reply["uptime_ms"] = millis();
+    } else {
+      ok = false;
+    }
+    reply["ok"] = ok;
+    if (debug_log_enabled()) {
+      Serial.printf("[STREAM] Command '%s' %s\n", cmd, ok ? "applied" : "rejected");
+    }
+
+    char buffer[192];
+    size_t replyLength = serializeJson(reply, buffer, sizeof(buffer));
+    streamSocket.sendTXT(buffer, replyLength);
+  }
+}
+
+void stream_event(WStype_t type, uint8_t *payload, size_t length) {
+  switch (type) {
+    case WStype_CONNECTED:
+      Serial.println("[STREAM] Connected");
+      streamConnected = true;
+      streamSender.reset();
+      break;
+    case WStype_DISCONNECTED:
+      if (streamConnected) {
+        Serial.println("[STREAM] Disconnected");
+      }
+      streamConnected = false;
+      streamSender.reset();
+      break;
+    case WStype_TEXT:
+      handle_stream_message(payload, length);
+      break;
+    default:
+      break;
+  }
+}
+
+void report_stream_stats() {
+  Serial.printf("[STREAM] %s | sent %u, acked %u, coalesced %u, blocked %u, lost %u, queue dropped %u\n",
+                streamConnected ? "connected" : "offline",
+                streamSender.sent(), streamSender.acked(), streamSender.coalesced(),
+                streamSender.blocked(), streamSender.lost(), streamQueue.dropped());
+  Serial.printf("[STREAM] Latency (ms) send->ack p50 %.1f p95 %.1f | capture->ack p50 %.1f p95 %.1f\n",
+                streamSendToAck.percentile(50) / 1000.0, streamSendToAck.percentile(95) / 1000.0,
+                streamCaptureToAck.percentile(50) / 1000.0, streamCaptureToAck.percentile(95) / 1000.0);
+}
+
+// Owns the WebSocket. Frames from the control core are coalesced so only the
+// newest is pending, and at most STREAM_MAX_IN_FLIGHT are unacknowledged.
+void streamTask(void *pvParameters) {
+  if (STREAM_USE_TLS) {
+    streamSocket.beginSSL(STREAM_HOST, STREAM_PORT, STREAM_PATH);
+  } else {
+    streamSocket.begin(STREAM_HOST, STREAM_PORT, STREAM_PATH);
+  }
+  streamSocket.onEvent(stream_event);
+  streamSocket.setReconnectInterval(STREAM_RECONNECT_INTERVAL);
+  streamSocket.enableHeartbeat(15000, 3000, 2);
+
+  unsigned long lastReport = 0;
+  StreamFrame frame;
+  uint32_t seq;
+  esp_task_wdt_add(NULL);
+
+  while (1) {
+    uint32_t busyStart = micros();
+
+    while (streamQueue.pop(frame)) {
+      streamSender.offer(frame, frame.captureUs);
+    }
+
+    if (WiFi.isConnected()) {
+      streamSocket.loop();
+    }
+
+    streamSender.expire(micros(), STREAM_ACK_TIMEOUT);
+    if (streamConnected && streamSender.take(frame, seq, micros())) {
+      send_stream_frame(frame, seq);
+    }
+
+    if (millis() - lastReport >= TASK_STATS_INTERVAL) {
+      lastReport = millis();
+      report_stream_stats();
+    }
+
+    esp_task_wdt_reset();
+    coreBusyUs[NETWORK_CORE].fetch_add(micros() - busyStart, std::memory_order_relaxed);
+    vTaskDelay(pdMS_TO_TICKS(STREAM_TASK_INTERVAL));
+  }
+}
+
+#ifdef SAFEDRIVE_BENCH
+// Kernel benchmarks on the target, enabled with -DSAFEDRIVE_BENCH.
+// tools/host_bench.cpp runs the same kernels on the host.
+void run_benchmarks() {
+  const int BENCH_SAMPLES = 64;
+  static float ax[BENCH_SAMPLES], ay[BENCH_SAMPLES], az[BENCH_SAMPLES];
+  for (int i = 0; i < BENCH_SAMPLES; i++) {
+    float roll = 0.5f * sinf(i * 0.1f);
+    ax[i] = 0.3f * cosf(i * 0.7f);
+    ay[i] = 9.81f * sinf(roll);
+    az[i] = 9.81f * cosf(roll);
+  }
+
+  Serial.println("[BENCH] Running kernel benchmarks...");
+
+  OrientationFilter filter(IMU_FILTER_BETA);
+  float acc = 0;
+  double cycles = bench_cycles_per_call(20000, [&](uint32_t i) {
+    int k = i % BENCH_SAMPLES;
+    filter.update(ax[k], ay[k], az[k], 0.01f, -0.02f, 0.005f, CONTROL_LOOP_INTERVAL / 1000.0f);
+    acc += filter.rollDeg() + filter.pitchDeg();
+  });
+  bench_keep(acc);
+  Serial.printf("[BENCH] Orientation update+angles: %.1f cycles (%.2f us)\n",
+                cycles, cycles / ESP.getCpuFreqMHz());
+
+  cycles = bench_cycles_per_call(20000, [&](uint32_t i) {
+    acc += fastmath::atan2(ay[i % BENCH_SAMPLES], az[i % BENCH_SAMPLES]);
+  });
+  bench_keep(acc);
+  Serial.printf("[BENCH] fastmath::atan2: %.1f cycles\n", cycles);
+
+  cycles = bench_cycles_per_call(20000, [&](uint32_t i) {
+    acc += atan2f(ay[i % BENCH_SAMPLES], az[i % BENCH_SAMPLES]);
+  });
+  bench_keep(acc);
+  Serial.printf("[BENCH] libm atan2f: %.1f cycles\n", cycles);
+
+  static uint16_t window[VIBRATION_WINDOW];
+  for (int i = 0; i < VIBRATION_WINDOW; i++) {
+    window[i] = 1800 + (int)(120.0f * sinf(i * 0.28f)) + (i * 37) % 50;
+  }
+  static VibrationAnalyzer<VIBRATION_WINDOW> analyzer(VIBRATION_SAMPLE_RATE, vibrationBandEdges);
+  VibrationFeatures features;
+  cycles = bench_cycles_per_call(200, [&](uint32_t) {
+    analyzer.analyze(window, features);
+    bench_keep(features);
+  });
+  Serial.printf("[BENCH] Vibration window (%d samples): %.0f cycles, %.0f windows/s per core\n",
+                VIBRATION_WINDOW, cycles, ESP.getCpuFreqMHz() * 1e6 / cycles);
+}
+#endif
+
+#if SAFEDRIVE_TRACE
+void init_trace() {
+#if SAFEDRIVE_TRACE == 2
+  if (!LittleFS.begin(true)) {
+    Serial.println("[TRACE] LittleFS mount failed, recording disabled");
+    return;
+  }
+  traceFile = LittleFS.open(TRACE_FILE_PATH, "w");
+  if (!traceFile) {
+    Serial.println("[TRACE] Could not open " TRACE_FILE_PATH);
+    return;
+  }
+  Serial.println("[TRACE] Recording to " TRACE_FILE_PATH);
+#else
+  Serial.println("[TRACE] Streaming framed records on Serial");
+#endif
+  uint32_t version = TRACE_FORMAT_VERSION;
+  trace_control(TRACE_BOOT, 0, &version, sizeof(version));
+}
+
+// Consumer side of both trace queues, runs on the network core
+void flush_trace() {
+  TraceRecord record;
+  uint8_t frame[TRACE_MAX_FRAME];
+
+  while (traceQueue.pop(record) || traceVibrationQueue.pop(record) || traceBodyQueue.pop(record)) {
+    size_t length = trace_encode_frame(record, frame);
+#if SAFEDRIVE_TRACE == 2
+    if (!traceFile || traceBytesWritten + length > TRACE_MAX_FILE_BYTES) {
+      continue;  // Full or unavailable: drain without writing
+    }
+    traceFile.write(frame, length);
+#else
+    Serial.write(frame, length);
+#endif
+    traceBytesWritten += length;
+  }
+
+#if SAFEDRIVE_TRACE == 2
+  static unsigned long lastFlush = 0;
+  if (traceFile && millis() - lastFlush >= TRACE_FLUSH_INTERVAL) {
+    lastFlush = millis();
+    traceFile.flush();
+  }
+#endif
+}
+#endif
+
+// Producer side of trackQueue: one entry per GPS epoch (GGA and RMC both update the location)
+void record_track_fix() {
+  static uint32_t lastFixTime = 0xffffffff;
+  uint32_t fixTime = gps.time.value();
+  if (fixTime == lastFixTime) return;
+  lastFixTime = fixTime;
+
+  TrackFix fix;
+  fix.timeMs = millis();
+  fix.latE7 = (int32_t)lround(gps.location.lat() * 1e7);
+  fix.lngE7 = (int32_t)lround(gps.location.lng() * 1e7);
+  fix.speedCms = gps.speed.isValid() ? (uint16_t)lround(gps.speed.mps() * 100.0) : 0;
+  trackQueue.push(fix);
+}
+
+// Producer side of gpsTimeQueue. Must run before anything reads gps.time,
+// since reading it clears the updated flag.
+void record_gps_time(int64_t sentenceStartUs) {
+  if (!gps.date.isValid() || !gps.time.isValid() || gps.date.year() < 2020) return;
+  TimeObservation obs;
+  obs.monoUs = sentenceStartUs;
+  obs.utcUs = clock_utc_from_civil(gps.date.year(), gps.date.month(), gps.date.day(),
+                                   gps.time.hour(), gps.time.minute(), gps.time.second(),
+                                   gps.time.centisecond());
+  gpsTimeQueue.push(obs);
+}
+
+// Runs on the lwIP task after each SNTP sync has set the system time
+void on_sntp_sync(struct timeval *tv) {
+  TimeObservation obs;
+  obs.monoUs = esp_timer_get_time();
+  obs.utcUs = (int64_t)tv->tv_sec * 1000000LL + tv->tv_usec;
+  sntpTimeQueue.push(obs);
+}
+
+void init_time_service() {
+  sntp_set_time_sync_notification_cb(on_sntp_sync);
+  sntp_set_sync_interval(TIME_SNTP_SYNC_INTERVAL);
+  configTime(0, 0, TIME_NTP_SERVER_1, TIME_NTP_SERVER_2);  // Retries on its own until WiFi is up
+}
+
+// Consumer side of both time queues, on the network task: feeds the
+// references to the discipline and republishes the clock when it changes
+void update_device_clock() {
+  TimeObservation obs;
+  bool changed = false;
+  while (gpsTimeQueue.pop(obs)) {
+    changed |= clockDiscipline.addGps(obs.monoUs, obs.utcUs);
+  }
+  while (sntpTimeQueue.pop(obs)) {
+    changed |= clockDiscipline.addSntp(obs.monoUs, obs.utcUs);
+  }
+  if (changed) {
+    deviceClock.write(clockDiscipline.model());
+  }
+}
+
+const char *time_source_name(uint8_t source) {
+  switch (source) {
+    case TIME_SOURCE_GPS: return "gps";
+    case TIME_SOURCE_SNTP: return "sntp";
+    default: return "none";
+  }
+}
+
+String trip_file_path(uint32_t id) {
+  return String(TRIP_DIR "/") + id + ".trk";
+}
+
+void init_trips() {
+  if (!LittleFS.begin(true)) {
+    Serial.println("[TRIP] LittleFS mount failed, trip recording disabled");
+    return;
+  }
+  LittleFS.mkdir(TRIP_DIR);
+  tripPrefs.begin("trips", false);
+  tripStorageReady = true;
+}
+
+// Appends the current segment to the active trip file as length + bytes
+void write_trip_segment() {
+  if (trackSegment.empty()) return;
+  uint16_t length = trackSegment.size();
+  if (LittleFS.totalBytes() - LittleFS.usedBytes() < (size_t)TRIP_MIN_FREE_BYTES + length) {
+    Serial.println("[TRIP] Filesystem full, dropping segment");
+  } else {
+    File file = LittleFS.open(trip_file_path(tripId), "a");
+    if (file) {
+      file.write((const uint8_t *)&length, sizeof(length));
+      file.write(trackSegment.data(), length);
+      file.close();
+      tripStats.bytesWritten += length;
+      tripStats.segmentsWritten++;
+    }
+  }
+  trackSegment.reset();
+}
+
+void store_track_fix(const TrackFix &fix) {
+  if (trackSegment.empty()) {
+    tripSegmentStart = millis();
+  }
+  if (!trackSegment.append(fix)) {
+    write_trip_segment();
+    tripSegmentStart = millis();
+    trackSegment.append(fix);
+  }
+  tripStats.kept++;
+}
+
+void end_trip() {
+  TrackFix kept;
+  if (trackSimplifier.flush(kept)) {
+    store_track_fix(kept);
+  }
+  write_trip_segment();
+  trackSimplifier.reset();
+  Serial.printf("[TRIP] Trip %u ended\n", tripId);
+  tripId = 0;
+}
+
+// Consumer side of trackQueue: trip start/end, simplification and storage
+void update_trip_recorder() {
+  TrackFix fix;
+  while (trackQueue.pop(fix)) {
+    tripStats.fixes++;
+    if (!tripStorageReady) continue;
+
+    bool moving = fix.speedCms >= TRIP_START_SPEED;
+    if (tripId == 0) {
+      if (!moving) continue;
+      tripId = tripPrefs.getUInt("next", 1);
+      tripPrefs.putUInt("next", tripId + 1);
+      Serial.printf("[TRIP] Trip %u started\n", tripId);
+    }
+    if (moving) {
+      tripLastMovingMs = fix.timeMs;
+    }
+
+    TrackFix kept;
+    bench_cycles_t start = bench_cycles();
+    bool keep = trackSimplifier.add(fix, kept);
+    tripStats.cycles += bench_cycles() - start;
+    if (keep) {
+      store_track_fix(kept);
+    }
+
+    if (!moving && fix.timeMs - tripLastMovingMs >= TRIP_END_IDLE) {
+      end_trip();
+    }
+  }
+
+  // Don't sit on a partly filled segment for long, so uploads keep up with the drive
+  if (tripId != 0 && !trackSegment.empty() && millis() - tripSegmentStart >= TRIP_SEGMENT_INTERVAL) {
+    write_trip_segment();
+  }
+}
+
+// Uploads the next stored segment, oldest trip first, and removes trip files
+// once they are finished and fully sent. The upload position is not persisted,
+// so after a reboot a trip is re-sent from its first segment, and the server
+// stores those segments twice unless it de-duplicates on trip id and segment
+// number (each upload carries both).
+void upload_trip_segment() {
+  if (!tripStorageReady || !WiFi.isConnected()) return;
+
+  if (tripUploadPath.length() == 0) {
+    uint32_t oldest = 0;
+    File dir = LittleFS.open(TRIP_DIR);
+    for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+      uint32_t id = atoi(entry.name());
+      if (id != 0 && (oldest == 0 || id < oldest)) oldest = id;
+    }
+    if (oldest == 0) return;
+    tripUploadId = oldest;
+    tripUploadPath = trip_file_path(oldest);
+    tripUploadOffset = 0;
+    tripUploadSegment = 0;
+  }
+
+  File file = LittleFS.open(tripUploadPath, "r");
+  if (!file) {
+    tripUploadPath = "";
+    return;
+  }
+
+  uint8_t segment[TRACK_SEGMENT_BYTES];
+  uint16_t length = 0;
+  if (tripUploadOffset + sizeof(length) > file.size()) {
+    file.close();
+    if (tripUploadId != tripId) {
+      LittleFS.remove(tripUploadPath);  // Finished and fully sent
+      tripUploadPath = "";
+    }
+    return;
+  }
+  file.seek(tripUploadOffset);
+  file.read((uint8_t *)&length, sizeof(length));
+  bool complete = length <= TRACK_SEGMENT_BYTES && file.read(segment, length) == length;
+  file.close();
+  if (!complete) {
+    Serial.printf("[TRIP] Trip %u is corrupt after segment %u, discarding the rest\n",
+                  tripUploadId, tripUploadSegment);
+    if (tripUploadId != tripId) {
+      LittleFS.remove(tripUploadPath);
+      tripUploadPath = "";
+    }
+    return;
+  }
+
+  HTTPClient tripHttp;
+  tripHttp.begin(BACKEND_TRIP_URL);
+  tripHttp.addHeader("Content-Type", "application/octet-stream");
+  tripHttp.addHeader("X-Device-Id", WiFi.macAddress());
+  tripHttp.addHeader("X-Trip-Id", String(tripUploadId));
+  tripHttp.addHeader("X-Segment", String(tripUploadSegment));
+  tripHttp.addHeader("X-Track-Format", String(TRACK_FORMAT_VERSION));
+  int httpCode = tripHttp.POST(segment, length);
+  tripHttp.end();
+
+  if (httpCode >= 200 && httpCode < 300) {
+    tripUploadOffset += sizeof(length) + length;
+    tripUploadSegment++;
+    tripStats.segmentsUploaded++;
+  } else {
+    tripStats.uploadFailures++;
+  }
+}
+
+// Confirms an accident from the current readings. AlertGate allows one alert
+// per ACCIDENT_COOLDOWN, or a new one when the accident escalates.
+bool check_accident() {
+  float impactG = vehicleState.impact / 9.81f;
+  int level = accident_level(vehicleState.distance, vehicleState.roadCondition, impactG,
+                             vehicleState.roll, vehicleState.pitch);
+  if (!accidentGate.admit(level, millis())) return false;
+  currentAccidentLevel = level;
+  return true;
+}
+
+// Producer side of accidentQueue: hands the confirmed accident to the Alert task
+void send_accident_alert() {
+  AccidentEvent event;
+  event.detectUs = micros();
+  event.detectMs = millis();
+  event.level = currentAccidentLevel;
+  event.lat = lat;
+  event.lng = lng;
+  event.gpsValid = gps.location.isValid();
+  event.impactG = vehicleState.impact / 9.81f;
+  event.roll = vehicleState.roll;
+  event.pitch = vehicleState.pitch;
+  event.distance = vehicleState.distance;
+  accidentQueue.push(event);
+
+  currentLcdState = LCD_STATE_WARNING;
+  lcdStateTimeout = event.detectMs + LCD_WARNING_DURATION;
+  update_lcd_status("!! ACCIDENT !!", "Alerting L" + String(event.level));
+}
+
+String accident_message(const AccidentEvent &event) {
+  String message = "ACCIDENT DETECTED! Level " + String(event.level) +
+                   ", impact " + String(event.impactG, 1) + "g";
+  if (event.gpsValid) {
+    message += ". Location: https://maps.google.com/?q=" + String(event.lat, 6) + "," + String(event.lng, 6);
+  } else {
+    message += ". Location unavailable (no GPS fix)";
+  }
+  return message;
+}
+
+void gsm_command(const String &command, GsmAlertStep next) {
+  GSM.println(command);
+  gsmStep = next;
+  gsmStepStart = millis();
+}
+
+// Texts the next contact that still needs one, or moves on to the call
+void send_next_sms() {
+  while (gsmContact < EMERGENCY_CONTACT_COUNT) {
+    bool duplicate = false;
+    for (size_t i = 0; i < gsmContact; i++) {
+      duplicate = duplicate || strcmp(emergencyContacts[i], emergencyContacts[gsmContact]) == 0;
+    }
+    if (!duplicate) break;
+    alertTimeline.skipped(gsmContact, micros());
+    gsmContact++;
+  }
+  if (gsmContact >= EMERGENCY_CONTACT_COUNT) {
+    make_emergency_call();
+    return;
+  }
+  if (gsmAttempts == 0) {
+    alertTimeline.started(gsmContact, micros());
+  }
+  gsm_command(String("AT+CMGS=\"") + emergencyContacts[gsmContact] + "\"", GSM_ALERT_SMS_PROMPT);
+}
+
+void sms_failed() {
+  GSM.write(27);  // ESC abandons a half-entered message
+  if (++gsmAttempts > ALERT_SMS_RETRIES) {
+    Serial.printf("[ALERT] SMS to %s failed\n", emergencyContacts[gsmContact]);
+    alertTimeline.failed(gsmContact, micros());
+    gsmContact++;
+    gsmAttempts = 0;
+  }
+  send_next_sms();
+}
+
+// Voice call to the primary contact once every SMS has been handled
+void make_emergency_call() {
+  alertTimeline.started(ALERT_CHANNEL_CALL, micros());
+  gsm_command(String("ATD") + EMERGENCY_PHONE_NUMBER + ";", GSM_ALERT_DIALLING);
+}
+
+// Takes the next queued accident and starts every channel at once
+void start_alert(const AccidentEvent &event) {
+  activeAlert = event;
+  alertTimeline.begin(event.detectUs, micros(), ALERT_CHANNEL_COUNT);
+  alertActive.store(true, std::memory_order_release);
+  xTaskNotifyGive(alertPostTaskHandle);
+
+  Serial.printf("[ALERT] Level %d accident, dispatched %.1f ms after detection\n",
+                event.level, alertTimeline.dispatchLatencyUs() / 1000.0);
+  alertMessage = accident_message(event);
+  while (GSM.available()) GSM.read();  // Drop anything left over from setup
+  gsmLineLength = 0;
+  gsmContact = 0;
+  gsmAttempts = 0;
+  gsm_command("AT+CMGF=1", GSM_ALERT_TEXT_MODE);
+}
+
+void handle_gsm_line(const char *line) {
+  bool ok = strcmp(line, "OK") == 0;
+  bool error = strstr(line, "ERROR") != NULL;
+  bool callEnded = strstr(line, "NO CARRIER") || strstr(line, "BUSY") || strstr(line, "NO ANSWER");
+
+  switch (gsmStep) {
+    case GSM_ALERT_TEXT_MODE:
+      if (ok || error) send_next_sms();  // Text mode is normally already set by setup()
+      break;
+    case GSM_ALERT_SMS_PROMPT:
+      if (error) sms_failed();
+      break;
+    case GSM_ALERT_SMS_SENT:
+      if (strncmp(line, "+CMGS:", 6) == 0) {
+        alertTimeline.delivered(gsmContact, micros());
+        Serial.printf("[ALERT] SMS to %s accepted after %.1f ms\n", emergencyContacts[gsmContact],
+                      alertTimeline.latencyUs(gsmContact) / 1000.0);
+        gsmContact++;
+        gsmAttempts = 0;
+        send_next_sms();
+      } else if (error) {
+        sms_failed();
+      }
+      break;
+    case GSM_ALERT_DIALLING:
+      if (ok) {
+        alertTimeline.delivered(ALERT_CHANNEL_CALL, micros());
+        Serial.printf("[ALERT] Call to %s placed after %.1f ms\n", EMERGENCY_PHONE_NUMBER,
+                      alertTimeline.latencyUs(ALERT_CHANNEL_CALL) / 1000.0);
+        gsmStep = GSM_ALERT_IN_CALL;
+        gsmStepStart = millis();
+      } else if (error || callEnded) {
+        alertTimeline.failed(ALERT_CHANNEL_CALL, micros());
+        gsmStep = GSM_ALERT_IDLE;
+      }
+      break;
+    case GSM_ALERT_IN_CALL:
+      if (callEnded) gsmStep = GSM_ALERT_IDLE;
+      break;
+    case GSM_ALERT_HANGUP:
+      if (ok || error) gsmStep = GSM_ALERT_IDLE;
+      break;
+    default:
+      break;
+  }
+}
+
+// Reads modem output without blocking and applies the step timeouts
+void poll_gsm_alert() {
+  while (GSM.available()) {
+    char c = GSM.read();
+    if (c == '>' && gsmLineLength == 0 && gsmStep == GSM_ALERT_SMS_PROMPT) {
+      GSM.print(alertMessage);
+      GSM.write(26);  // CTRL+Z
+      gsmStep = GSM_ALERT_SMS_SENT;
+      gsmStepStart = millis();
+    } else if (c == '\r' || c == '\n') {
+      if (gsmLineLength > 0) {
+        gsmLine[gsmLineLength] = '\0';
+        gsmLineLength = 0;
+        handle_gsm_line(gsmLine);
+      }
+    } else if (gsmLineLength < sizeof(gsmLine) - 1) {
+      gsmLine[gsmLineLength++] = c;
+    }
+  }
+
+  unsigned long elapsed = millis() - gsmStepStart;
+  switch (gsmStep) {
+    case GSM_ALERT_TEXT_MODE:
+      if (elapsed >= ALERT_AT_TIMEOUT) send_next_sms();
+      break;
+    case GSM_ALERT_SMS_PROMPT:
+      if (elapsed >= ALERT_AT_TIMEOUT) sms_failed();
+      break;
+    case GSM_ALERT_SMS_SENT:
+      if (elapsed >= ALERT_SMS_TIMEOUT) sms_failed();
+      break;
+    case GSM_ALERT_DIALLING:
+      if (elapsed >= ALERT_DIAL_TIMEOUT) {
+        alertTimeline.failed(ALERT_CHANNEL_CALL, micros());
+        gsm_command("ATH", GSM_ALERT_HANGUP);
+      }
+      break;
+    case GSM_ALERT_IN_CALL:
+      if (elapsed >= ALERT_CALL_DURATION) gsm_command("ATH", GSM_ALERT_HANGUP);
+      break;
+    case GSM_ALERT_HANGUP:
+      if (elapsed >= ALERT_AT_TIMEOUT) gsmStep = GSM_ALERT_IDLE;
+      break;
+    default:
+      break;
+  }
+}
+
+// Publishes the per-channel latencies once every channel has finished
+void finish_alert() {
+  static const char *const channelNames[] = {"call", "backend"};
+  static AlertReport report = {};   // The Alert task's own copy, published below
+  report.count++;
+  report.level = activeAlert.level;
+  report.dispatchMs = alertTimeline.dispatchLatencyUs() / 1000;
+  int32_t first = alertTimeline.firstNotificationUs();
+  report.firstMs = first < 0 ? -1 : first / 1000;
+  for (size_t i = 0; i < ALERT_MAX_CHANNELS; i++) {
+    int32_t latency = i < ALERT_CHANNEL_COUNT ? alertTimeline.latencyUs(i) : -1;
+    report.channelMs[i] = latency < 0 ? -1 : latency / 1000;
+  }
+  alertReport.write(report);
+  alertActive.store(false, std::memory_order_release);
+
+  Serial.printf("[ALERT] Level %d done: first notification after %d ms (dispatch %d ms)\n",
+                report.level, report.firstMs, report.dispatchMs);
+  for (size_t i = 0; i < ALERT_CHANNEL_COUNT; i++) {
+    const char *state = alertTimeline.state(i) == ALERT_CHANNEL_DELIVERED ? "delivered"
+                      : alertTimeline.state(i) == ALERT_CHANNEL_SKIPPED ? "skipped (duplicate)" : "failed";
+    if (i < EMERGENCY_CONTACT_COUNT) {
+      Serial.printf("[ALERT]   sms %s: %s, sent %d ms, delivered %d ms\n", emergencyContacts[i], state,
+                    alertTimeline.startLatencyUs(i) / 1000, report.channelMs[i]);
+    } else {
+      Serial.printf("[ALERT]   %s: %s, sent %d ms, delivered %d ms\n",
+                    channelNames[i - EMERGENCY_CONTACT_COUNT], state,
+                    alertTimeline.startLatencyUs(i) / 1000, report.channelMs[i]);
+    }
+  }
+}
+
+// Owns the GSM modem after setup. SMS and the call share the modem, so they
+// run in sequence; the backend event runs alongside in alertPostTask.
+void alertTask(void *pvParameters) {
+  AccidentEvent event;
+  esp_task_wdt_add(NULL);
+
+  while (1) {
+    uint32_t busyStart = micros();
+    if (alertActive.load(std::memory_order_relaxed)) {
+      poll_gsm_alert();
+      if (gsmStep == GSM_ALERT_IDLE && alertTimeline.complete()) {
+        finish_alert();
+      }
+    } else if (accidentQueue.pop(event)) {
+      start_alert(event);
+    }
+
+    esp_task_wdt_reset();
+    coreBusyUs[NETWORK_CORE].fetch_add(micros() - busyStart, std::memory_order_relaxed);
+    vTaskDelay(pdMS_TO_TICKS(ALERT_TASK_INTERVAL));
+  }
+}
+
+// High-priority accident event for the backend, on its own task and HTTP
+// client so it never queues behind a periodic POST already in flight
+void alertPostTask(void *pvParameters) {
+  DynamicJsonDocument alertDoc(512);
+
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    const AccidentEvent event = activeAlert;
+
+    alertDoc.clear();
+    alertDoc["device_id"] = WiFi.macAddress();
+    alertDoc["priority"] = "high";
+    alertDoc["level"] = event.level;
+    alertDoc["detected_ms"] = event.detectMs - startTime;
+    alertDoc["impact_g"] = event.impactG;
+    alertDoc["roll"] = event.roll;
+    alertDoc["pitch"] = event.pitch;
+    alertDoc["distance"] = event.distance;
+    alertDoc["gps_valid"] = event.gpsValid;
+    if (event.gpsValid) {
+      alertDoc["lat"] = event.lat;
+      alertDoc["lng"] = event.lng;
+    }
+    String body;
+    serializeJson(alertDoc, body);
+
+    alertTimeline.started(ALERT_CHANNEL_BACKEND, micros());
+    bool delivered = false;
+    for (int attempt = 0; attempt < ALERT_POST_RETRIES && !delivered; attempt++) {
+      if (!WiFi.isConnected()) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        continue;
+      }
+      HTTPClient alertHttp;
+      alertHttp.setTimeout(ALERT_POST_TIMEOUT);
+      alertHttp.begin(BACKEND_ACCIDENT_URL);
+      alertHttp.addHeader("Content-Type", "application/json");
+      int httpCode = alertHttp.POST(body);
+      alertHttp.end();
+      delivered = httpCode >= 200 && httpCode < 300;
+      if (!delivered) {
+        Serial.printf("[ALERT] Backend event attempt %d failed: %d\n", attempt + 1, httpCode);
+      }
+    }
+
+    if (delivered) {
+      alertTimeline.delivered(ALERT_CHANNEL_BACKEND, micros());
+      Serial.printf("[ALERT] Backend event acknowledged after %.1f ms\n",
+                    alertTimeline.latencyUs(ALERT_CHANNEL_BACKEND) / 1000.0);
+    } else {
+      alertTimeline.failed(ALERT_CHANNEL_BACKEND, micros());
+    }
+  }
+}
+
+void networkTask(void *pvParameters) {
+  TelemetrySample sample;
+  LcdMessage msg;
+  esp_task_wdt_add(NULL);
+
+  while (1) {
+    uint32_t busyStart = micros();
+    unsigned long now = millis();
+
+    update_wifi();
+
+    // Only the newest LCD text matters, older queued messages are skipped
+    bool lcdPending = false;
+    while (lcdQueue.pop(msg)) {
+      lcdPending = true;
+    }
+    if (lcdPending) {
+      draw_lcd(msg.line1, msg.line2);
+    } else {
+      flush_lcd();  // Cells left over when the I2C queue was full
+    }
+
+    while (telemetryQueue.pop(sample)) {
+      record_telemetry_sample(sample);
+    }
+
+    update_trip_recorder();
+    update_device_clock();
+
+#if SAFEDRIVE_TRACE
+    flush_trace();
+#endif
+
+    // Send data to backend; the history upload waits while the control path
+    // is over budget, and while an alert is using the modem and the network
+    if (now - lastBackendUpdate >= BACKEND_UPDATE_INTERVAL) {
+      lastBackendUpdate = now;
+      if (alertActive.load(std::memory_order_acquire)) {
+        preemptedUploads.fetch_add(1, std::memory_order_relaxed);
+      } else if (deadlineMonitor.shedding()) {
+        shedUploads.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        deadlineMonitor.begin(stageBackendPost, micros());
+        send_to_backend();
+        deadlineMonitor.end(stageBackendPost, micros());
+      }
+    }
+
+    if (now - lastTripUpload >= TRIP_UPLOAD_INTERVAL) {
+      lastTripUpload = now;
+      if (alertActive.load(std::memory_order_acquire)) {
+        preemptedUploads.fetch_add(1, std::memory_order_relaxed);
+      } else if (deadlineMonitor.shedding()) {
+        shedUploads.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        upload_trip_segment();
+      }
+    }
+
+    if (now - lastTaskStatsReport >= TASK_STATS_INTERVAL) {
+      lastTaskStatsReport = now;
+      report_task_stats();
+    }
+
+    esp_task_wdt_reset();
+    coreBusyUs[NETWORK_CORE].fetch_add(micros() - busyStart, std::memory_order_relaxed);
+    vTaskDelay(pdMS_TO_TICKS(NETWORK_TASK_INTERVAL));
+  }
+}
+
+// Blocking body sensor reads at idle priority, so they only run while the
+// control loop (priority 1) is waiting for its next tick
+void bodySensorTask(void *pvParameters) {
+  esp_task_wdt_add(NULL);
+
+  while (1) {
+    deadlineMonitor.begin(stageBodySensors, micros());
+    BodySensorReading reading;
+    reading.seatbelt = check_seat_belt();
+    reading.pulse = measure_bpm(PULSE_PIN, BPM_WINDOW_SEC);
+    reading.lastStoredPulse = pulseHistory[(pulseHistoryIndex - 1 + PULSE_HISTORY_SIZE) % PULSE_HISTORY_SIZE];
+    reading.pulseTimestamp = lastPulseTimestamp;
+    bodySensorQueue.push(reading);
+    end_task_stage(stageBodySensors);
+
+    vTaskDelay(pdMS_TO_TICKS(SENSOR_UPDATE_INTERVAL));
+  }
 }
 
 void start_motor() {
@@ -691,7 +2588,7 @@ void start_motor() {
   
   // Initialize and show system values
   vehicleState.distance = measure_distance();
-  vehicleState.alcoholLevel = check_alcohol();
+  update_alcohol();
   vehicleState.pulse = measure_bpm(PULSE_PIN, 5);
   
   // Show initial system values after motors start
@@ -714,8 +2611,11 @@ void stop_motor() {
   digitalWrite(MOTOR_IN3, LOW);
   digitalWrite(MOTOR_IN4, LOW);
   
+  // Held for LCD_ENGINE_DURATION by the LCD state timeout; this runs on the
+  // control path and must not block
+  currentLcdState = LCD_STATE_ENGINE;
+  lcdStateTimeout = millis() + LCD_ENGINE_DURATION;
   update_lcd_status("Engines Status:", "Stopped");
-  delay(1000);
 }
 
 void set_motor_speed(int speed) {
@@ -731,52 +2631,91 @@ void set_motor_speed(int speed) {
   digitalWrite(MOTOR_IN3, speed > 0 ? HIGH : LOW);
   digitalWrite(MOTOR_IN4, LOW);
   
-  Serial.printf("[MOTOR] Speed set to: %d\n", speed);
+  if (debug_log_enabled()) {
+    Serial.printf("[MOTOR] Speed set to: %d\n", speed);
+  }
 }
 
-void IRAM_ATTR echoISR() {
-  uint32_t now = micros();
-  if (digitalRead(ULTRASONIC_ECHO) == HIGH) {
-    pulseStart = now;
-  } else if (pulseStart > 0) {
-    currentDistance = ((now - pulseStart) * 34) / 2000;
-    if (currentDistance >= ULTRASONIC_MIN_DIST && currentDistance <= ULTRASONIC_MAX_DIST) {
-      newDistanceAvailable = true;
+// Shared by every echo pin; the sensor index comes in as the interrupt argument
+void IRAM_ATTR echoISR(void *arg) {
+  uint8_t sensor = (uintptr_t)arg;
+  bool high = digitalRead(ultrasonicSensors[sensor].echoPin) == HIGH;
+  if (echoDemux.onEdge(sensor, high, micros())) {
+    // Last echo of the slot: let the trigger task move on without waiting out the timeout
+    BaseType_t higherPriorityWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(ultrasonicTaskHandle, &higherPriorityWoken);
+    if (higherPriorityWoken) {
+      portYIELD_FROM_ISR();
     }
-    pulseStart = 0;
   }
 }
 
+// Fires the trigger slots in turn. A slot ends when all of its sensors have
+// echoed or after ULTRASONIC_TIMEOUT, then waits ULTRASONIC_INTERVAL so the
+// next slot cannot pick up its reverberation.
 void ultrasonicTask(void *pvParameters) {
+  const uint8_t slots = ultrasonic_slot_count(ultrasonicSensors, ULTRASONIC_SENSOR_COUNT);
+  uint8_t slot = 0;
+
   while (1) {
-    GPIO.out_w1ts = (1 << ULTRASONIC_TRIG);
-    asm("nop; nop; nop; nop; nop; nop; nop; nop;");
-    GPIO.out_w1tc = (1 << ULTRASONIC_TRIG);
+    uint32_t mask = ultrasonic_slot_mask(ultrasonicSensors, ULTRASONIC_SENSOR_COUNT, slot);
+    ulTaskNotifyTake(pdTRUE, 0);  // Drop a completion left over from the last slot
+    echoDemux.arm(mask);
+
+    for (size_t i = 0; i < ULTRASONIC_SENSOR_COUNT; i++) {
+      if (mask & (1u << i)) digitalWrite(ultrasonicSensors[i].trigPin, HIGH);
+    }
+    delayMicroseconds(10);  // HC-SR04 trigger pulse
+    for (size_t i = 0; i < ULTRASONIC_SENSOR_COUNT; i++) {
+      if (mask & (1u << i)) digitalWrite(ultrasonicSensors[i].trigPin, LOW);
+    }
+
+    if (mask) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ULTRASONIC_TIMEOUT / 1000));
+    }
     vTaskDelay(pdMS_TO_TICKS(ULTRASONIC_INTERVAL));
+    slot = (slot + 1) % slots;
   }
 }
 
-long measure_distance() {
-  static long lastValidDistance = ULTRASONIC_MAX_DIST;
-  static int errorCount = 0;
-  
-  if (!newDistanceAvailable) {
-    errorCount++;
-    if (errorCount > 10) {
-      lastValidDistance = ULTRASONIC_MAX_DIST;
-      errorCount = 0;
+// Newest echo of one sensor. Out-of-range echoes count as no reading; after
+// more than 10 polls without a reading the object is taken as gone.
+long read_sensor_distance(uint8_t sensor) {
+  static int errorCount[ULTRASONIC_MAX_SENSORS] = {0};
+  EchoSample sample;
+  long distance = -1;
+
+  if (echoDemux.latest(sensor, sample)) {
+    long cm = echo_to_cm(sample.echoUs);
+    TraceUltrasonic echo = {(int32_t)cm};
+    trace_control(TRACE_ULTRASONIC, sensor, &echo, sizeof(echo));
+    if (cm >= ULTRASONIC_MIN_DIST && cm <= ULTRASONIC_MAX_DIST) {
+      distance = cm;
     }
-    return lastValidDistance;
   }
-  
-  errorCount = 0;
-  newDistanceAvailable = false;
-  
-  if (currentDistance < ULTRASONIC_MIN_DIST || currentDistance > ULTRASONIC_MAX_DIST) {
-    return lastValidDistance;
+
+  if (distance < 0) {
+    if (++errorCount[sensor] > 10) {
+      sensorDistance[sensor] = ULTRASONIC_MAX_DIST;
+      errorCount[sensor] = 0;
+    }
+    return sensorDistance[sensor];
+  }
+
+  errorCount[sensor] = 0;
+  sensorDistance[sensor] = distance;
+  return distance;
+}
+
+// Nearest obstacle seen by the forward-facing sensors
+long measure_distance() {
+  long lastValidDistance = ULTRASONIC_MAX_DIST;
+  for (size_t i = 0; i < ULTRASONIC_SENSOR_COUNT; i++) {
+    long distance = read_sensor_distance(i);
+    if (ultrasonicSensors[i].forward && distance < lastValidDistance) {
+      lastValidDistance = distance;
+    }
   }
-  
-  lastValidDistance = currentDistance;
   
   // Control LED based on distance thresholds
   if (lastValidDistance < EMERGENCY_DISTANCE) {
@@ -792,28 +2731,38 @@ long measure_distance() {
     digitalWrite(DISTANCE_LED_PIN, LOW);  // OFF when safe
   }
   
-  return currentDistance;
+  return lastValidDistance;
 }
 
-int check_alcohol() {
-  long sum = 0;
-  for (int i = 0; i < 5; i++) {
-    int reading = analogRead(MQ3_PIN);
-    sum += reading;
-    Serial.printf("Alcohol Raw Reading %d: %d\n", i, reading);
-    delay(ALCOHOL_READ_DELAY);
+// Control job, every ALCOHOL_SAMPLE_INTERVAL: one MQ-3 read through the
+// alcohol pipeline (warm-up, drift and temperature handling in alcohol_pipeline.h)
+void update_alcohol() {
+  int reading = analogRead(MQ3_PIN);
+  trace_adc(TRACE_ADC_ALCOHOL, reading);
+  AlcoholState previous = alcoholPipeline.state();
+  AlcoholState state = alcoholPipeline.update(millis(), reading, imuTempValid ? temp.temperature : NAN);
+
+  vehicleState.alcoholLevel = (int)alcoholPipeline.level();
+  vehicleState.alcoholState = state;
+  digitalWrite(ALCOHOL_LED_PIN, state == ALCOHOL_DETECTED ? HIGH : LOW);
+
+  if (state != previous) {
+    const AlcoholStats &stats = alcoholPipeline.stats();
+    Serial.printf("[ALCOHOL] %s: level %d, baseline %.0f | warm-up took %u ms, %u detections, %u rejected by debounce\n",
+                  alcohol_state_name(state), vehicleState.alcoholLevel, alcoholPipeline.baseline(),
+                  stats.warmupMs, stats.detections, stats.rejected);
+  } else if (debug_log_enabled()) {
+    Serial.printf("Alcohol raw %d, level %d, baseline %.0f, %s\n", reading, vehicleState.alcoholLevel,
+                  alcoholPipeline.baseline(), alcohol_state_name(state));
+  }
+}
+
+const char *alcohol_state_name(uint8_t state) {
+  switch (state) {
+    case ALCOHOL_CLEAR: return "clear";
+    case ALCOHOL_DETECTED: return "detected";
+    default: return "warming up";
   }
-  int alcoholLevel = sum / 5;
-  
-  // Force LED update and debug output
-  bool isAlcoholDetected = alcoholLevel >= ALCOHOL_THRESHOLD;
-  digitalWrite(ALCOHOL_LED_PIN, isAlcoholDetected ? HIGH : LOW);
-  
-  Serial.printf("Alcohol Level: %d, Threshold: %d, LED: %s\n", 
-                alcoholLevel, ALCOHOL_THRESHOLD, 
-                isAlcoholDetected ? "ON" : "OFF");
-  
-  return alcoholLevel;
 }
 
 int measure_bpm(int pin, int measurement_time_sec) {
@@ -824,13 +2773,18 @@ int measure_bpm(int pin, int measurement_time_sec) {
 
   while (millis() - start_time < measurement_duration) {
     int raw_value = analogRead(pin);
-    Serial.printf("Pulse Raw: %d\n", raw_value); // Debug output
+    trace_adc(TRACE_ADC_PULSE, raw_value);
+    if (debug_log_enabled()) {
+      Serial.printf("Pulse Raw: %d\n", raw_value); // Debug output
+    }
 
     // Check if we have a pulse beat
     if (raw_value > PULSE_THRESHOLD && !above_threshold) {
       beats++;
       above_threshold = true;
-      Serial.printf("Beat detected! Count: %d\n", beats);
+      if (debug_log_enabled()) {
+        Serial.printf("Beat detected! Count: %d\n", beats);
+      }
     } else if (raw_value <= PULSE_THRESHOLD) {
       above_threshold = false;
     }
@@ -842,14 +2796,14 @@ int measure_bpm(int pin, int measurement_time_sec) {
   float seconds = measurement_duration / 1000.0;
   float bpm = (beats * 60.0) / seconds;
   
-  Serial.printf("Measured BPM: %.1f over %d seconds\n", bpm, measurement_time_sec);
+  if (debug_log_enabled()) {
+    Serial.printf("Measured BPM: %.1f over %d seconds\n", bpm, measurement_time_sec);
+  }
   
   // Validate the reading
   if (bpm >= MIN_BPM && bpm <= MAX_BPM) {
-    // Store validated pulse data with timestamp
-    pulseDataHistory[pulseDataIndex].timestamp = millis();
-    pulseDataHistory[pulseDataIndex].value = (int)bpm;
-    pulseDataIndex = (pulseDataIndex + 1) % PULSE_DATA_POINTS;
+    // Timestamp the validated reading; the network core records it in pulseDataHistory
+    lastPulseTimestamp = millis();
 
     // Store in regular history
     pulseHistory[pulseHistoryIndex] = (int)bpm;
@@ -870,71 +2824,83 @@ void send_to_backend() {
   http.begin(BACKEND_URL);
   http.addHeader("Content-Type", "application/json");
   
-  // Clear and create fresh JSON document
-  jsonDoc.clear();
-  
-  // Add timestamp in ISO format
-  unsigned long uptime = millis() - startTime;
+  // Timestamp in UTC milliseconds once the clock has a reference, uptime before that
+  static ClockModel clock = {};   // Last good model, kept while a write is in progress
+  deviceClock.tryRead(clock);
   char timestamp[25];
-  snprintf(timestamp, sizeof(timestamp), "%lu000", uptime); // Convert to milliseconds
-  
-  jsonDoc["device_id"] = WiFi.macAddress();
-  jsonDoc["timestamp"] = timestamp;
-  jsonDoc["alcohol"] = vehicleState.alcoholLevel;
-  jsonDoc["vibration"] = vehicleState.vibration;
-  jsonDoc["distance"] = vehicleState.distance;
-  jsonDoc["seatbelt"] = vehicleState.seatbelt;
-  jsonDoc["impact"] = vehicleState.impact;
-  jsonDoc["pulse"] = vehicleState.pulse;
-  jsonDoc["lcd_display"] = currentLcdText;  // Add LCD display text
-
-  // Always include GPS coordinates, even if they're 0
-  if (gps.location.isValid()) {
-      jsonDoc["lat"] = lat;
-      jsonDoc["lng"] = lng;
-      jsonDoc["gps_valid"] = true;
-      jsonDoc["satellites"] = gps.satellites.value();
+  if (clock.valid) {
+    snprintf(timestamp, sizeof(timestamp), "%lld", (long long)(clock_to_utc(clock, esp_timer_get_time()) / 1000));
   } else {
-      jsonDoc["gps_valid"] = false;
+    unsigned long uptime = millis() - startTime;
+    snprintf(timestamp, sizeof(timestamp), "%lu000", uptime); // Convert to milliseconds
   }
-
-  // Add current pulse reading separately for real-time display
-  jsonDoc["current_pulse"] = vehicleState.pulse;
-  jsonDoc["pulse_threshold_min"] = MIN_BPM;
-  jsonDoc["pulse_threshold_max"] = MAX_BPM;
-
-  // Add detailed pulse history with timestamps
-  JsonArray pulseData = jsonDoc["pulse_data"].to<JsonArray>();
-  for (int i = 0; i < PULSE_DATA_POINTS; i++) {
-    int idx = (pulseDataIndex - 1 - i + PULSE_DATA_POINTS) % PULSE_DATA_POINTS;
-    if (pulseDataHistory[idx].timestamp > 0) {  // Only send valid readings
-      JsonObject reading = pulseData.add<JsonObject>();
-      reading["timestamp"] = pulseDataHistory[idx].timestamp;
-      reading["value"] = pulseDataHistory[idx].value;
-    }
+  
+  // Runs on the network core: the core readings come from the newest
+  // snapshot, the rest from the latest queued sample, never vehicleState
+  const VehicleState &state = latestTelemetry.state;
+  VehicleSnapshot now;
+  if (!read_vehicle_snapshot(now)) {
+    now.roll = state.roll;
+    now.pitch = state.pitch;
+    now.impact = state.impact;
+    now.distance = state.distance;
+    now.alcoholLevel = state.alcoholLevel;
+    now.pulse = state.pulse;
+    now.speed = state.speed;
   }
 
-  // Add current readings to history arrays
-  JsonArray pulseHistoryArray = jsonDoc["pulse_history"].to<JsonArray>();
-  JsonArray distanceHistory = jsonDoc["distance_history"].to<JsonArray>();
-  JsonArray alcoholHistory = jsonDoc["alcohol_history"].to<JsonArray>();
-  JsonArray impactHistory = jsonDoc["impact_history"].to<JsonArray>();
-  JsonArray vibrationHistory = jsonDoc["vibration_history"].to<JsonArray>();
-
-  // Add latest readings first
-  for (int i = HISTORY_SIZE - 1; i >= 0; i--) {
-    int idx = (sensorHistory.index - i + HISTORY_SIZE) % HISTORY_SIZE;
-    pulseHistoryArray.add(sensorHistory.pulse[idx]);
-    distanceHistory.add(sensorHistory.distance[idx]);
-    alcoholHistory.add(sensorHistory.alcohol[idx]);
-    impactHistory.add(sensorHistory.impact[idx]);
-    vibrationHistory.add(sensorHistory.vibration[idx]);
+  // Same document builder as tools/load_gen.cpp
+  String deviceId = WiFi.macAddress();
+  static AlertReport lastAlert = {};   // Kept when the Alert task is mid-write
+  alertReport.tryRead(lastAlert);
+  TelemetryPayload payload = {};
+  payload.deviceId = deviceId.c_str();
+  payload.timestamp = timestamp;
+  payload.timeSource = time_source_name(clock.valid ? clock.source : TIME_SOURCE_NONE);
+  payload.clockValid = clock.valid;
+  if (clock.valid) {
+    payload.utcUs = clock_to_utc(clock, latestTelemetry.captureMonoUs);
+    payload.sentUtcUs = clock_to_utc(clock, esp_timer_get_time());
+    payload.clockUncertaintyUs = clock.uncertaintyUs;
+  }
+  payload.alcohol = now.alcoholLevel;
+  payload.alcoholState = alcohol_state_name(state.alcoholState);
+  payload.vibration = state.vibration;
+  payload.vibrationRms = state.vibrationRms;
+  payload.roadCondition = state.roadCondition;
+  payload.vibrationBands = state.vibrationBands;
+  payload.vibrationBandCount = VIBRATION_BANDS;
+  payload.distance = now.distance;
+  payload.seatbelt = state.seatbelt;
+  payload.impact = now.impact;
+  payload.pulse = now.pulse;
+  payload.roll = now.roll;
+  payload.pitch = now.pitch;
+  payload.speed = now.speed;
+  payload.lcdDisplay = currentLcdText.c_str();
+  payload.gpsValid = latestTelemetry.gpsValid;
+  payload.lat = latestTelemetry.lat;
+  payload.lng = latestTelemetry.lng;
+  payload.satellites = latestTelemetry.satellites;
+  payload.alert = &lastAlert;
+  payload.smsChannels = EMERGENCY_CONTACT_COUNT;
+  payload.link = &wifiLink.stats();
+  payload.linkUptimePct = wifiLink.upPermille() / 10.0f;
+  payload.rssi = WiFi.RSSI();
+  payload.pulseMin = MIN_BPM;
+  payload.pulseMax = MAX_BPM;
+  payload.pulseData = pulseDataHistory;
+  payload.pulseDataIndex = pulseDataIndex;
+  payload.history = &sensorHistory;
+
+  size_t length = write_telemetry_payload(payload, backendPayload, sizeof(backendPayload));
+  if (length == 0) {
+    Serial.println("[HTTP] Payload exceeds TELEMETRY_PAYLOAD_MAX, not sent");
+    http.end();
+    return;
   }
 
-  String jsonString;
-  serializeJson(jsonDoc, jsonString);
-  
-  int httpCode = http.POST(jsonString);
+  int httpCode = http.POST((uint8_t *)backendPayload, length);
   Serial.printf("[HTTP] POST result: %d\n", httpCode);
   if (httpCode == HTTP_CODE_OK) {
     String response = http.getString();
@@ -944,12 +2910,152 @@ void send_to_backend() {
   http.end();
 }
 
-void get_gps_data() {
+// Burst read of the accelerometer, temperature and gyro registers through the
+// I2C task into a, g and temp (the units mpu.getEvent() uses). False if the
+// read failed or took longer than IMU_READ_TIMEOUT.
+bool read_imu() {
+  I2cTransaction txn = {};
+  txn.clockHz = I2C_IMU_CLOCK;
+  txn.tag = ++imuRequestTag;
+  txn.notify = xTaskGetCurrentTaskHandle();
+  txn.address = IMU_ADDRESS;
+  txn.writeLength = 1;
+  txn.data[0] = IMU_REG_ACCEL_XOUT_H;
+  txn.readLength = 14;
+  if (!i2c_submit(I2C_LEVEL_IMU, txn)) return false;
+
+  // A read that timed out earlier may still deliver its result and wake us; skip it
+  I2cResult result;
+  bool received = false;
+  TickType_t waitStart = xTaskGetTickCount();
+  while (!received) {
+    while (!received && i2cBus.result(I2C_LEVEL_IMU, result)) {
+      received = result.tag == txn.tag;
+    }
+    if (received) break;
+    TickType_t waited = xTaskGetTickCount() - waitStart;
+    if (waited >= pdMS_TO_TICKS(IMU_READ_TIMEOUT) ||
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IMU_READ_TIMEOUT) - waited) == 0) {
+      imuReadTimeouts.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+  if (result.error) return false;
+
+  auto word = [&result](int i) { return (int16_t)((result.data[i] << 8) | result.data[i + 1]); };
+  const float accelScale = SENSORS_GRAVITY_STANDARD / IMU_ACCEL_LSB_PER_G;
+  const float gyroScale = SENSORS_DPS_TO_RADS / IMU_GYRO_LSB_PER_DPS;
+  a.acceleration.x = word(0) * accelScale;
+  a.acceleration.y = word(2) * accelScale;
+  a.acceleration.z = word(4) * accelScale;
+  temp.temperature = word(6) / 340.0f + 36.53f;
+  imuTempValid = true;
+  g.gyro.x = word(8) * gyroScale;
+  g.gyro.y = word(10) * gyroScale;
+  g.gyro.z = word(12) * gyroScale;
+  return true;
+}
+
+// Fuses accelerometer and gyro every control loop (CONTROL_LOOP_INTERVAL)
+void update_orientation() {
+  static uint32_t lastImuMicros = 0;
+
+  if (!read_imu()) return;  // Keep the previous orientation until the next read
+  uint32_t now = micros();
+  float dt = lastImuMicros ? (now - lastImuMicros) * 1e-6f : CONTROL_LOOP_INTERVAL / 1000.0f;
+  lastImuMicros = now;
+
+#if SAFEDRIVE_TRACE
+  TraceImu imu = {a.acceleration.x, a.acceleration.y, a.acceleration.z,
+                  g.gyro.x, g.gyro.y, g.gyro.z, temp.temperature};
+  trace_control(TRACE_IMU, 0, &imu, sizeof(imu));
+#endif
+
+  orientationFilter.update(a.acceleration.x, a.acceleration.y, a.acceleration.z,
+                           g.gyro.x, g.gyro.y, g.gyro.z, dt);
+  vehicleState.roll = orientationFilter.rollDeg();
+  vehicleState.pitch = orientationFilter.pitchDeg();
+  vehicleState.impact = fastmath::sqrt(sq(a.acceleration.x) + sq(a.acceleration.y) + sq(a.acceleration.z));
+}
+
+#if SAFEDRIVE_TRACE
+// Splits a finished window into TRACE_ADC_BLOCK records, each stamped with its last sample
+void trace_vibration_window(const uint16_t *samples, uint32_t windowEndUs) {
+  const uint16_t periodUs = 1000000 / VIBRATION_SAMPLE_RATE;
+  uint8_t payload[TRACE_MAX_PAYLOAD];
+  memcpy(payload, &periodUs, sizeof(periodUs));
+  for (int start = 0; start < VIBRATION_WINDOW; start += TRACE_ADC_BLOCK_SAMPLES) {
+    int count = VIBRATION_WINDOW - start;
+    if (count > TRACE_ADC_BLOCK_SAMPLES) count = TRACE_ADC_BLOCK_SAMPLES;
+    memcpy(payload + sizeof(periodUs), samples + start, count * sizeof(uint16_t));
+    uint32_t lastSampleUs = windowEndUs - (VIBRATION_WINDOW - start - count) * periodUs;
+    trace_push(traceVibrationQueue, lastSampleUs, TRACE_ADC_BLOCK, TRACE_ADC_VIBRATION,
+               payload, sizeof(periodUs) + count * sizeof(uint16_t));
+  }
+}
+#endif
+
+void IRAM_ATTR vibrationTimerISR() {
+  BaseType_t higherPriorityWoken = pdFALSE;
+  vTaskNotifyGiveFromISR(vibrationTaskHandle, &higherPriorityWoken);
+  if (higherPriorityWoken) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+// Takes one ADC sample per timer tick and analyses each full window
+void vibrationTask(void *pvParameters) {
+  static uint16_t samples[VIBRATION_WINDOW];
+  size_t count = 0;
+
+  while (1) {
+    uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (ticks > 1) {
+      vibrationMissedSamples.fetch_add(ticks - 1, std::memory_order_relaxed);
+    }
+    samples[count++] = analogRead(VIBRATION_PIN);
+
+    if (count == VIBRATION_WINDOW) {
+      uint32_t busyStart = micros();
+#if SAFEDRIVE_TRACE
+      trace_vibration_window(samples, busyStart);
+#endif
+      VibrationFeatures features;
+      vibrationAnalyzer.analyze(samples, features);
+      features.windowEndMs = millis();
+      features.roadCondition = classify_vibration(features);
+      vibrationQueue.push(features);
+      count = 0;
+      coreBusyUs[CONTROL_CORE].fetch_add(micros() - busyStart, std::memory_order_relaxed);
+    }
+  }
+}
+
+// Consumer side of vibrationQueue: latest window wins
+void update_vibration() {
+  VibrationFeatures features;
+  bool updated = false;
+  while (vibrationQueue.pop(features)) {
+    updated = true;
+    if (features.roadCondition == ROAD_IMPACT) {
+      break;  // Keep the impact window visible rather than a later calm one
+    }
+  }
+  if (!updated) return;
+
+  vehicleState.vibration = features.peak;
+  vehicleState.vibrationRms = features.rms;
+  memcpy(vehicleState.vibrationBands, features.bandEnergy, sizeof(vehicleState.vibrationBands));
+  vehicleState.roadCondition = features.roadCondition;
+}
+
+bool braking = false;
+unsigned long brakeStart = 0;
+unsigned long gpsShownUntil = 0;   // GPS screen stays up until then
+
+// Control job, every tick: IMU, vibration windows, accident and braking checks
+void update_motion() {
     unsigned long currentMillis = millis();
-    static unsigned long lastGpsUpdate = 0;
-    static unsigned long lastGpsDisplay = 0;
-    static bool is_braking = false;
-    static unsigned long brake_start = 0;
 
     // Handle LCD state timeout
     if (currentLcdState != LCD_STATE_NORMAL && currentMillis > lcdStateTimeout) {
@@ -957,88 +3063,111 @@ void get_gps_data() {
     }
 
     // Read MPU6050 data
-    mpu.getEvent(&a, &g, &temp);
-    vehicleState.roll = atan2(a.acceleration.y, a.acceleration.z) * 180.0 / PI;
-    vehicleState.pitch = atan2(-a.acceleration.x, sqrt(sq(a.acceleration.y) + sq(a.acceleration.z))) * 180.0 / PI;
-    vehicleState.impact = sqrt(sq(a.acceleration.x) + sq(a.acceleration.y) + sq(a.acceleration.z));
+    update_orientation();
+    update_vibration();
+    if (check_accident()) {
+        send_accident_alert();
+    }
 
     // Detect braking
-    if (a.acceleration.x < -RAPID_DECEL_THRESHOLD && !is_braking) {
-        is_braking = true;
-        brake_start = currentMillis;
+    if (is_rapid_decel(a.acceleration.x) && !braking) {
+        braking = true;
+        brakeStart = currentMillis;
         update_lcd_status("!!! BRAKING !!!", String(abs(a.acceleration.x), 1) + "g force");
-    } else if (!is_braking || (currentMillis - brake_start > 2000)) {
-        is_braking = false;
-        // Show all values on LCD in compact format
-        String line1 = String("D") + vehicleState.distance +
-                      " A" + vehicleState.alcoholLevel +
-                      " I" + String(vehicleState.impact, 1);
-        String line2 = String("HR:") + String(vehicleState.pulse) +
-                      " H" + pulseHistory[((pulseHistoryIndex - 1 + PULSE_HISTORY_SIZE) % PULSE_HISTORY_SIZE)];
-        update_lcd_status(line1, line2);
-    }
-
-    // Process GPS data with higher priority
+    } else if (braking && currentMillis - brakeStart > 2000) {
+        braking = false;
+    }
+}
+
+// Control job, every tick: drains the GPS UART so no NMEA bytes are lost
+void read_gps() {
+    static int64_t sentenceStartUs = 0;
     while (Serial1.available() > 0) {
-        if (gps.encode(Serial1.read())) {
+        char c = Serial1.read();
+        trace_nmea_byte(c);
+        if (c == '$') {
+            sentenceStartUs = esp_timer_get_time();
+        }
+        if (gps.encode(c)) {
+            if (gps.time.isUpdated()) {
+                record_gps_time(sentenceStartUs);
+            }
             if (gps.location.isValid() && gps.date.isValid() && gps.time.isValid()) {
+                bool newFix = gps.location.isUpdated();
                 lat = gps.location.lat();
                 lng = gps.location.lng();
-
-                // Update LCD with GPS data every 2 seconds
-                if (currentMillis - lastGpsDisplay >= 2000) {
-                    lastGpsDisplay = currentMillis;
-                    String line1 = String("GPS:") + String(lat, 4);
-                    String line2 = String("Long:") + String(lng, 4);
-                    update_lcd_status(line1, line2);
+                if (gps.speed.isValid()) {
+                    vehicleState.speed = gps.speed.kmph();
                 }
-
-                // Debug output every 5 seconds
-                if (currentMillis - lastGpsUpdate >= 5000) {
-                    lastGpsUpdate = currentMillis;
-                    Serial.printf("[GPS] Position: %.6f, %.6f | Satellites: %d\n",
-                        lat, lng, gps.satellites.value());
+                if (newFix) {
+                    record_track_fix();
                 }
             }
         }
     }
+    trace_nmea_flush();
+}
 
-    // Check for GPS timeout
-    if (millis() > 5000 && gps.charsProcessed() < 10) {
-        Serial.println("[GPS] No GPS detected");
+// Control job, every SENSOR_UPDATE_INTERVAL
+void read_sensors() {
+    // Distance comes from the motor job, the only reader of the echo slots;
+    // body sensors arrive from their own task
+    while (bodySensorQueue.pop(bodyReading)) {
+        vehicleState.seatbelt = bodyReading.seatbelt;
+        vehicleState.pulse = bodyReading.pulse;
     }
 
-    // Read sensors
-    if (currentMillis - lastSensorRead >= SENSOR_UPDATE_INTERVAL) {
-        lastSensorRead = currentMillis;
+    // Hand the snapshot to the network core (history, logging, backend)
+    TelemetrySample sample;
+    sample.timeMs = millis();
+    sample.captureMonoUs = esp_timer_get_time();
+    sample.state = vehicleState;
+    sample.lat = lat;
+    sample.lng = lng;
+    sample.gpsValid = gps.location.isValid();
+    sample.satellites = gps.satellites.value();
+    sample.pulseTimestamp = bodyReading.pulseTimestamp;
+    telemetryQueue.push(sample);
+}
 
-        // Update all sensor readings
-        vehicleState.distance = measure_distance();
-        vehicleState.alcoholLevel = check_alcohol();
-        vehicleState.seatbelt = check_seat_belt();
-        vehicleState.pulse = measure_bpm(PULSE_PIN, 5); // 5-second measurement window
-        vehicleState.vibration = analogRead(VIBRATION_PIN);  // Add vibration reading
+// Control job, every SENSOR_UPDATE_INTERVAL: the compact sensor screen,
+// unless a warning, a braking message or the GPS screen is showing
+void refresh_lcd() {
+    if (currentLcdState != LCD_STATE_NORMAL || braking || (long)(millis() - gpsShownUntil) < 0) {
+        return;
+    }
+    if (deadlineMonitor.shedding()) {
+        shedLcdRefreshes.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // Show all values on LCD in compact format
+    String line1 = String("D") + vehicleState.distance +
+                  " A" + vehicleState.alcoholLevel +
+                  " I" + String(vehicleState.impact, 1);
+    String line2 = String("HR:") + String(vehicleState.pulse) +
+                  " H" + bodyReading.lastStoredPulse;
+    update_lcd_status(line1, line2);
+}
 
-        // Store in history with bounds checking
-        if (vehicleState.distance > 0 && vehicleState.distance <= ULTRASONIC_MAX_DIST) {
-            sensorHistory.distance[sensorHistory.index] = vehicleState.distance;
-        }
-        sensorHistory.alcohol[sensorHistory.index] = vehicleState.alcoholLevel;
-        sensorHistory.impact[sensorHistory.index] = vehicleState.impact;
-        sensorHistory.pulse[sensorHistory.index] = vehicleState.pulse;
-        sensorHistory.vibration[sensorHistory.index] = vehicleState.vibration;
-        sensorHistory.index = (sensorHistory.index + 1) % HISTORY_SIZE;
-
-        // Debug output
-        Serial.printf("Sensor Update - D:%ld A:%d I:%.2f P:%d V:%d S:%s\n",
-                     vehicleState.distance, vehicleState.alcoholLevel,
-                     vehicleState.impact, vehicleState.pulse,
-                     vehicleState.vibration, vehicleState.seatbelt ? "ON" : "OFF");
-    }
-
-    // Send data to backend
-    if (currentMillis - lastBackendUpdate >= BACKEND_UPDATE_INTERVAL) {
-        lastBackendUpdate = currentMillis;
-        send_to_backend();
+// Control job, every GPS_DISPLAY_INTERVAL: position screen for DISPLAY_UPDATE_INTERVAL
+void show_gps_position() {
+    if (!gps.location.isValid() || deadlineMonitor.shedding() ||
+        currentLcdState == LCD_STATE_WARNING || braking) {
+        return;
     }
-}
\ No newline at end of file
+    gpsShownUntil = millis() + DISPLAY_UPDATE_INTERVAL;
+    String line1 = String("GPS:") + String(lat, 4);
+    String line2 = String("Long:") + String(lng, 4);
+    update_lcd_status(line1, line2);
+}
+
+// Control job, every GPS_REPORT_INTERVAL
+void report_gps() {
+    if (!debug_log_enabled()) return;
+    if (millis() > 5000 && gps.charsProcessed() < 10) {
+        Serial.println("[GPS] No GPS detected");
+    } else if (gps.location.isValid()) {
+        Serial.printf("[GPS] Position: %.6f, %.6f | Satellites: %d\n",
+            lat, lng, gps.satellites.value());
+    }
+}
@@ -0,0 +1,1032 @@
+// Host-side benchmarks for the portable firmware kernels in include/.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -Iinclude tools/host_bench.cpp -o host_bench -pthread
+//   ./host_bench            # all benchmarks
+//   ./host_bench orientation
+//
+// The same kernels are benchmarked on the ESP32 by building the firmware with
+// -DSAFEDRIVE_BENCH (see run_benchmarks() in main.cpp).
+//
+// Some benchmarks also check their results (accuracy bounds, detection
+// times); a failed check prints FAIL and the run exits with status 1.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "alcohol_pipeline.h"
+#include "bench.h"
+#include "control_logic.h"
+#include "fast_math.h"
+#include "i2c_bus.h"
+#include "lcd_backpack.h"
+#include "link_manager.h"
+#include "orientation_filter.h"
+#include "schedule.h"
+#include "seqlock.h"
+#include "spsc_queue.h"
+#include "time_service.h"
+#include "track_codec.h"
+#include "ultrasonic_array.h"
+#include "vibration_features.h"
+
+namespace {
+
+int checkFailures = 0;
+
+void check(bool ok, const char *what) {
+  if (ok) return;
+  printf("FAIL: %s\n", what);
+  checkFailures++;
+}
+
+struct ImuSample {
+  float ax, ay, az;
+  float gx, gy, gz;
+  float trueRoll, truePitch;  // Degrees
+};
+
+// Slow roll/pitch manoeuvre with engine vibration and sensor noise, 200 Hz
+std::vector<ImuSample> make_imu_trace(size_t count, float dt) {
+  std::mt19937 rng(42);
+  std::normal_distribution<float> accelNoise(0.0f, 0.4f);
+  std::normal_distribution<float> gyroNoise(0.0f, 0.01f);
+  std::vector<ImuSample> trace(count);
+  for (size_t i = 0; i < count; i++) {
+    const float t = i * dt;
+    const float roll = 0.5f * std::sin(0.5f * t);
+    const float pitch = 0.3f * std::sin(0.3f * t);
+    const float rollRate = 0.25f * std::cos(0.5f * t);
+    const float pitchRate = 0.09f * std::cos(0.3f * t);
+    const float vibration = 1.5f * std::sin(2.0f * 3.14159265f * 35.0f * t);
+
+    ImuSample &s = trace[i];
+    s.ax = -9.81f * std::sin(pitch) + accelNoise(rng) + vibration;
+    s.ay = 9.81f * std::sin(roll) * std::cos(pitch) + accelNoise(rng);
+    s.az = 9.81f * std::cos(roll) * std::cos(pitch) + accelNoise(rng) + vibration;
+    // Body rates for a ZYX rotation with zero yaw
+    s.gx = rollRate + gyroNoise(rng);
+    s.gy = pitchRate * std::cos(roll) + gyroNoise(rng);
+    s.gz = -pitchRate * std::sin(roll) + gyroNoise(rng);
+    s.trueRoll = roll * 57.2957795f;
+    s.truePitch = pitch * 57.2957795f;
+  }
+  return trace;
+}
+
+void bench_fast_math() {
+  double maxAtanErr = 0, maxInvSqrtErr = 0;
+  for (int i = -1000; i <= 1000; i++) {
+    for (int j = -1000; j <= 1000; j += 37) {
+      const float y = i * 0.01f, x = j * 0.01f;
+      maxAtanErr = std::fmax(maxAtanErr, std::fabs(fastmath::atan2(y, x) - std::atan2(y, x)));
+    }
+  }
+  for (int i = 1; i < 100000; i++) {
+    const float x = i * 0.013f;
+    maxInvSqrtErr = std::fmax(maxInvSqrtErr, std::fabs(fastmath::invSqrt(x) * std::sqrt(x) - 1.0));
+  }
+
+  const uint32_t n = 1000000;
+  float acc = 0;
+  const double fastAtan = bench_cycles_per_call(n, [&](uint32_t i) { acc += fastmath::atan2((float)(i & 1023) - 512.0f, 300.0f); });
+  const double libAtan = bench_cycles_per_call(n, [&](uint32_t i) { acc += std::atan2((float)(i & 1023) - 512.0f, 300.0f); });
+  const double fastInv = bench_cycles_per_call(n, [&](uint32_t i) { acc += fastmath::invSqrt((float)(i & 1023) + 1.0f); });
+  const double libInv = bench_cycles_per_call(n, [&](uint32_t i) { acc += 1.0f / std::sqrt((float)(i & 1023) + 1.0f); });
+  bench_keep(acc);
+
+  printf("[fast_math] atan2: %.1f cycles (libm %.1f), max error %.2e rad\n", fastAtan, libAtan, maxAtanErr);
+  printf("[fast_math] invSqrt: %.1f cycles (libm %.1f), max relative error %.2e\n", fastInv, libInv, maxInvSqrtErr);
+  // The bounds stated in fast_math.h
+  check(maxAtanErr < 2e-5, "fast_math: atan2 error over 2e-5 rad");
+  check(maxInvSqrtErr < 1e-6, "fast_math: invSqrt relative error over 1e-6");
+}
+
+void bench_orientation() {
+  const float dt = 0.005f;
+  const std::vector<ImuSample> trace = make_imu_trace(200 * 120, dt);
+
+  // Accuracy against the single-sample atan2 estimate the firmware used before
+  OrientationFilter filter(0.05f);
+  double filterErr = 0, rawErr = 0;
+  size_t scored = 0;
+  for (size_t i = 0; i < trace.size(); i++) {
+    const ImuSample &s = trace[i];
+    filter.update(s.ax, s.ay, s.az, s.gx, s.gy, s.gz, dt);
+    if (i < 200 * 5) continue;  // Skip convergence
+    const float rawRoll = std::atan2(s.ay, s.az) * 57.2957795f;
+    const float rawPitch = std::atan2(-s.ax, std::sqrt(s.ay * s.ay + s.az * s.az)) * 57.2957795f;
+    filterErr += std::fabs(filter.rollDeg() - s.trueRoll) + std::fabs(filter.pitchDeg() - s.truePitch);
+    rawErr += std::fabs(rawRoll - s.trueRoll) + std::fabs(rawPitch - s.truePitch);
+    scored++;
+  }
+
+  OrientationFilter timed(0.05f);
+  float acc = 0;
+  const double cycles = bench_cycles_per_call((uint32_t)trace.size(), [&](uint32_t i) {
+    const ImuSample &s = trace[i];
+    timed.update(s.ax, s.ay, s.az, s.gx, s.gy, s.gz, dt);
+    acc += timed.rollDeg() + timed.pitchDeg();
+  });
+  bench_keep(acc);
+
+  printf("[orientation] %.1f cycles per update+angles\n", cycles);
+  printf("[orientation] mean |error| roll+pitch: filter %.2f deg, raw atan2 %.2f deg\n",
+         filterErr / scored, rawErr / scored);
+}
+
+void bench_vibration() {
+  const float sampleRate = 1000.0f;
+  static VibrationAnalyzer<VIBRATION_WINDOW> analyzer(sampleRate, vibrationBandEdges);
+
+  // 60 s of engine vibration plus road noise, with one pothole strike
+  std::mt19937 rng(7);
+  std::normal_distribution<float> noise(0.0f, 40.0f);
+  std::vector<uint16_t> samples(60 * 1000);
+  for (size_t n = 0; n < samples.size(); n++) {
+    const float t = n / sampleRate;
+    float v = 1800.0f + 120.0f * std::sin(2.0f * 3.14159265f * 45.0f * t) + noise(rng);
+    if (n >= 30000 && n < 30040) v += 1500.0f * std::exp(-(n - 30000) / 10.0f);
+    samples[n] = (uint16_t)std::fmin(std::fmax(v, 0.0f), 4095.0f);
+  }
+
+  const uint32_t windows = (uint32_t)(samples.size() / VIBRATION_WINDOW);
+  VibrationFeatures f;
+  int impacts = 0;
+  for (uint32_t w = 0; w < windows; w++) {
+    analyzer.analyze(&samples[w * VIBRATION_WINDOW], f);
+    if (classify_vibration(f) == ROAD_IMPACT) impacts++;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const double cycles = bench_cycles_per_call(windows * 20, [&](uint32_t i) {
+    analyzer.analyze(&samples[(i % windows) * VIBRATION_WINDOW], f);
+    bench_keep(f);
+  });
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  printf("[vibration] %.0f cycles per %d-sample window (%.1f cycles/sample)\n", cycles, VIBRATION_WINDOW, cycles / VIBRATION_WINDOW);
+  printf("[vibration] throughput %.0f windows/s, %.2f Msamples/s\n",
+         windows * 20 / seconds, windows * 20 * VIBRATION_WINDOW / seconds / 1e6);
+  printf("[vibration] impact windows detected: %d (expected 1)\n", impacts);
+}
+
+// Same layout as VehicleSnapshot in main.cpp. Every field is derived from one
+// counter, so a reader can tell whether a copy mixes two writes.
+struct StressSnapshot {
+  uint32_t timeUs;
+  float roll, pitch, impact;
+  int32_t distance, alcoholLevel, pulse;
+  float speed;
+};
+
+StressSnapshot make_stress_snapshot(uint32_t n) {
+  return {n, (float)(n & 0xffff), -(float)(n & 0xffff), (float)(n & 0xff) * 0.5f,
+          (int32_t)n, (int32_t)~n, (int32_t)(n * 3u), (float)(n & 0x3ff)};
+}
+
+bool stress_snapshot_consistent(const StressSnapshot &s) {
+  const StressSnapshot expected = make_stress_snapshot(s.timeUs);
+  return memcmp(&s, &expected, sizeof(s)) == 0;
+}
+
+// Unsynchronised word-by-word copy, as reading vehicleState field by field would be
+class PlainWords {
+ public:
+  void write(const StressSnapshot &value) {
+    uint32_t words[kWords];
+    memcpy(words, &value, sizeof(value));
+    for (size_t i = 0; i < kWords; i++) words_[i].store(words[i], std::memory_order_relaxed);
+  }
+  bool tryRead(StressSnapshot &out) const {
+    uint32_t words[kWords];
+    for (size_t i = 0; i < kWords; i++) words[i] = words_[i].load(std::memory_order_relaxed);
+    memcpy(&out, words, sizeof(out));
+    return true;
+  }
+
+ private:
+  static constexpr size_t kWords = sizeof(StressSnapshot) / sizeof(uint32_t);
+  std::atomic<uint32_t> words_[kWords] = {};
+};
+
+template <typename Store>
+void run_snapshot_stress(const char *label, Store &store, int readers, double seconds) {
+  std::atomic<bool> stop(false);
+  std::atomic<uint64_t> reads(0), torn(0), retries(0);
+  uint64_t writes = 0;
+
+  std::vector<std::thread> threads;
+  for (int r = 0; r < readers; r++) {
+    threads.emplace_back([&] {
+      StressSnapshot s;
+      uint64_t localReads = 0, localTorn = 0, localRetries = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        while (!store.tryRead(s)) localRetries++;   // Readers are on other cores than the writer
+        if (!stress_snapshot_consistent(s)) localTorn++;
+        localReads++;
+      }
+      reads += localReads;
+      torn += localTorn;
+      retries += localRetries;
+    });
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds) {
+    for (int i = 0; i < 1000; i++) store.write(make_stress_snapshot((uint32_t)++writes));
+  }
+  stop = true;
+  for (std::thread &t : threads) t.join();
+
+  printf("[seqlock] %-8s %d readers: %llu writes, %llu reads, %llu retries, %llu torn\n", label, readers,
+         (unsigned long long)writes, (unsigned long long)reads.load(),
+         (unsigned long long)retries.load(), (unsigned long long)torn.load());
+}
+
+// Writer hammers the store while readers verify every copy they take
+void bench_seqlock() {
+  const int readers = (int)std::max(2u, std::thread::hardware_concurrency()) - 1;
+  static PlainWords plain;
+  run_snapshot_stress("plain", plain, readers, 1.0);
+  static SeqLock<StressSnapshot> seqlock;
+  seqlock.write(make_stress_snapshot(0));
+  run_snapshot_stress("seqlock", seqlock, readers, 1.0);
+
+  StressSnapshot s;
+  const double writeCycles = bench_cycles_per_call(1000000, [&](uint32_t i) { seqlock.write(make_stress_snapshot(i)); });
+  const double readCycles = bench_cycles_per_call(1000000, [&](uint32_t) { seqlock.tryRead(s); bench_keep(s); });
+  printf("[seqlock] uncontended write %.1f cycles, read %.1f cycles\n", writeCycles, readCycles);
+}
+
+// 20 minutes of city driving at 5 Hz: straight roads, right-angle turns, a
+// curved ring road and stops at lights, with 1.5 m of GPS noise
+std::vector<TrackFix> make_route() {
+  const float dt = 0.2f;
+  const double metresPerDegLat = 111319.0;
+  const double lat0 = 5.6037, lng0 = -0.1870;  // Accra
+  const double metresPerDegLng = metresPerDegLat * std::cos(lat0 * 3.14159265 / 180.0);
+
+  std::mt19937 rng(11);
+  std::normal_distribution<float> noise(0.0f, 1.5f);
+  std::vector<TrackFix> route;
+  double x = 0, y = 0, heading = 0;
+  float t = 0;
+  int leg = 0;
+  while (t < 1200.0f) {
+    // Each leg: accelerate, cruise, maybe curve, brake to a stop, then turn
+    const float cruise = 8.0f + 6.0f * (leg % 3);  // 8-20 m/s
+    const float legTime = 40.0f + 15.0f * (leg % 4);
+    const bool curved = leg % 5 == 2;
+    for (float lt = 0; lt < legTime && t < 1200.0f; lt += dt, t += dt) {
+      float speed = cruise;
+      if (lt < 8.0f) speed = cruise * lt / 8.0f;
+      if (lt > legTime - 6.0f) speed = cruise * (legTime - lt) / 6.0f;
+      if (speed < 0) speed = 0;
+      if (curved) heading += 0.02 * dt * speed / 10.0;
+      x += speed * dt * std::cos(heading);
+      y += speed * dt * std::sin(heading);
+
+      TrackFix fix;
+      fix.timeMs = (uint32_t)std::lround(t * 1000.0f);
+      fix.latE7 = (int32_t)std::lround((lat0 + (y + noise(rng)) / metresPerDegLat) * 1e7);
+      fix.lngE7 = (int32_t)std::lround((lng0 + (x + noise(rng)) / metresPerDegLng) * 1e7);
+      fix.speedCms = (uint16_t)std::lround(std::fmax(0.0f, speed + 0.1f * noise(rng)) * 100.0f);
+      route.push_back(fix);
+    }
+    heading += (leg % 2 ? -1 : 1) * 3.14159265 / 2;
+    leg++;
+  }
+  return route;
+}
+
+// Distance in metres from a fix to the decoded track, interpolated by time
+double track_error_m(const std::vector<TrackFix> &track, const TrackFix &fix) {
+  size_t i = 1;
+  while (i < track.size() - 1 && track[i].timeMs < fix.timeMs) i++;
+  const TrackFix &a = track[i - 1], &b = track[i];
+  const double f = b.timeMs == a.timeMs ? 0.0 : (double)(fix.timeMs - a.timeMs) / (b.timeMs - a.timeMs);
+  const double lat = a.latE7 + f * (b.latE7 - a.latE7), lng = a.lngE7 + f * (b.lngE7 - a.lngE7);
+  const double dy = (fix.latE7 - lat) * 0.0111319;
+  const double dx = (fix.lngE7 - lng) * 0.0111319 * std::cos(fix.latE7 * 1.745329e-9);
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+// Records one route the way the trip recorder does and decodes it back
+void bench_track() {
+  const float toleranceM = 5.0f;
+  const std::vector<TrackFix> route = make_route();
+  std::vector<std::vector<uint8_t>> segments;
+
+  TrackSimplifier simplifier(toleranceM, 200, 30000);
+  TrackSegmentWriter writer;
+  TrackFix kept;
+  size_t keptCount = 0;
+  auto store = [&](const TrackFix &fix) {
+    keptCount++;
+    if (!writer.append(fix)) {
+      segments.emplace_back(writer.data(), writer.data() + writer.size());
+      writer.reset();
+      writer.append(fix);
+    }
+  };
+  for (const TrackFix &fix : route) {
+    if (simplifier.add(fix, kept)) store(kept);
+  }
+  if (simplifier.flush(kept)) store(kept);
+  if (!writer.empty()) segments.emplace_back(writer.data(), writer.data() + writer.size());
+
+  size_t encodedBytes = 0;
+  std::vector<TrackFix> decoded;
+  TrackFix buffer[255];
+  for (const std::vector<uint8_t> &segment : segments) {
+    encodedBytes += segment.size();
+    const int n = track_decode_segment(segment.data(), segment.size(), buffer, 255);
+    if (n < 0) {
+      printf("[track] decode failed\n");
+      return;
+    }
+    decoded.insert(decoded.end(), buffer, buffer + n);
+  }
+  double maxError = 0, sumError = 0;
+  for (const TrackFix &fix : route) {
+    const double e = track_error_m(decoded, fix);
+    maxError = std::fmax(maxError, e);
+    sumError += e;
+  }
+
+  // Cost per fix of the online path: simplify, and encode whatever is kept
+  const size_t n = route.size();
+  TrackSimplifier timed(toleranceM, 200, 30000);
+  const double cycles = bench_cycles_per_call(n * 20, [&](uint32_t i) {
+    if (i % n == 0) {
+      timed.reset();
+      writer.reset();
+    }
+    TrackFix fix = route[i % n];
+    fix.timeMs += (i / n) * 1200000u;
+    if (timed.add(fix, kept) && !writer.append(kept)) {
+      writer.reset();
+      writer.append(kept);
+    }
+  });
+  bench_keep(writer.size());
+
+  const size_t rawBytes = n * 14;  // Packed time + lat + lng + speed
+  printf("[track] %zu fixes at 5 Hz -> %zu kept (%.1f%%) in %zu segments\n",
+         n, keptCount, 100.0 * keptCount / n, segments.size());
+  printf("[track] %zu raw bytes -> %zu encoded (%.1fx, %.1f bytes per kept fix, %.2f bytes per fix)\n",
+         rawBytes, encodedBytes, (double)rawBytes / encodedBytes,
+         (double)encodedBytes / keptCount, (double)encodedBytes / n);
+  printf("[track] error vs decoded track: mean %.2f m, max %.2f m (tolerance %.1f m)\n",
+         sumError / n, maxError, toleranceM);
+  printf("[track] %.1f cycles per fix\n", cycles);
+}
+
+// Sensors evenly spaced around the vehicle hear each other's bursts when they
+// are less than 100 degrees apart
+bool sensors_hear(int a, int b, int n) {
+  const float sep = std::fabs(std::remainder((a - b) * 360.0f / n, 360.0f));
+  return a != b && sep < 100.0f;
+}
+
+// Fewest slots k for which slot = i % k keeps sensors that hear each other apart
+std::vector<UltrasonicSensorConfig> make_sensor_ring(int n, bool staggered) {
+  std::vector<UltrasonicSensorConfig> sensors(n, UltrasonicSensorConfig{"sim", 0, 0, 0, true});
+  if (!staggered) return sensors;
+  for (int k = 1; k <= n; k++) {
+    bool clash = false;
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) clash |= i % k == j % k && sensors_hear(i, j, n);
+    }
+    if (clash) continue;
+    for (int i = 0; i < n; i++) sensors[i].slot = i % k;
+    break;
+  }
+  return sensors;
+}
+
+struct RangingResult {
+  uint8_t slots;
+  double readingsPerSec;   // In-range readings across all sensors
+  double corruptPercent;   // Readings more than 5 cm off
+};
+
+// Virtual-time model of ultrasonicTask() driving EchoDemux: 450 us burst
+// delay, echoes at 58.8 us/cm, no echo (38 ms high) for open space, sensors
+// busy until their echo ends, and the first return heard ending an echo
+RangingResult simulate_ranging(const std::vector<UltrasonicSensorConfig> &sensors, double seconds) {
+  const int n = (int)sensors.size();
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> range(20.0f, 300.0f);
+  std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+  std::unique_ptr<EchoDemux<ULTRASONIC_MAX_SENSORS>> demux(new EchoDemux<ULTRASONIC_MAX_SENSORS>());
+
+  const uint8_t slots = ultrasonic_slot_count(sensors.data(), n);
+  std::vector<float> distance(n);
+  std::vector<double> busyUntil(n, 0.0);
+  uint64_t readings = 0, corrupt = 0;
+  double t = 0, nextScene = 0;
+  uint8_t slot = 0;
+
+  // Echo edges in time order; late ones are delivered during later slots
+  struct Edge {
+    double at;
+    int sensor;
+    bool high;
+    bool operator>(const Edge &o) const { return at > o.at; }
+  };
+  std::priority_queue<Edge, std::vector<Edge>, std::greater<Edge>> edges;
+  auto deliver_until = [&](double until) {
+    while (!edges.empty() && edges.top().at <= until) {
+      const Edge e = edges.top();
+      edges.pop();
+      if (demux->onEdge(e.sensor, e.high, (uint32_t)e.at)) return e.at;
+    }
+    return -1.0;
+  };
+
+  while (t < seconds * 1e6) {
+    if (t >= nextScene) {
+      for (int i = 0; i < n; i++) distance[i] = chance(rng) < 0.1f ? 1000.0f : range(rng);
+      nextScene = t + 500000;
+    }
+    deliver_until(t);
+    const uint32_t armed = demux->arm(ultrasonic_slot_mask(sensors.data(), n, slot));
+    t += 10;  // Trigger pulse
+
+    for (int i = 0; i < n; i++) {
+      if (!(armed & (1u << i)) || t < busyUntil[i]) continue;
+      const double rise = t + 450;
+      double width = distance[i] < 400.0f ? distance[i] * 2000.0 / 34.0 : 38000.0;
+      for (int j = 0; j < n; j++) {
+        if ((armed & (1u << j)) && sensors_hear(i, j, n) && distance[j] < 400.0f) {
+          width = std::fmin(width, (distance[i] + distance[j]) * 0.5 * 2000.0 / 34.0);
+        }
+      }
+      edges.push({rise, i, true});
+      edges.push({rise + width, i, false});
+      busyUntil[i] = rise + width;
+    }
+
+    double slotEnd = armed ? t + 15000 : t;
+    const double completed = deliver_until(slotEnd);
+    if (completed >= 0) slotEnd = completed;
+    t = slotEnd + 2000;  // Guard between slots
+
+    EchoSample sample;
+    for (int i = 0; i < n; i++) {
+      if (demux->latest(i, sample)) {
+        const long cm = echo_to_cm(sample.echoUs);
+        if (cm < 5 || cm > 200) continue;
+        readings++;
+        if (std::fabs(cm - distance[i]) > 5.0f) corrupt++;
+      }
+    }
+    slot = (slot + 1) % slots;
+  }
+  return {slots, readings / seconds, readings ? 100.0 * corrupt / readings : 0.0};
+}
+
+// Aggregate ranging throughput for 1-8 sensors: shared slots, one sensor per
+// slot, and all sensors firing at once
+void bench_ultrasonic() {
+  for (int n = 1; n <= 8; n++) {
+    const RangingResult staggered = simulate_ranging(make_sensor_ring(n, true), 60.0);
+    std::vector<UltrasonicSensorConfig> sequential = make_sensor_ring(n, false);
+    for (int i = 0; i < n; i++) sequential[i].slot = i;
+    const RangingResult oneByOne = simulate_ranging(sequential, 60.0);
+    const RangingResult together = simulate_ranging(make_sensor_ring(n, false), 60.0);
+    printf("[ultrasonic] %d sensors: %u slots, %6.1f readings/s (%5.1f per sensor), %4.1f%% corrupt"
+           " | one per slot: %6.1f/s | all at once: %6.1f/s, %4.1f%% corrupt\n",
+           n, staggered.slots, staggered.readingsPerSec, staggered.readingsPerSec / n,
+           staggered.corruptPercent, oneByOne.readingsPerSec,
+           together.readingsPerSec, together.corruptPercent);
+  }
+
+  // Age of the echo the 50 ms motor job acts on at close range, a 3.5 ms slot
+  // cycle: a 4-deep queue keeps the oldest echoes since the last poll and
+  // drops the rest, the slot keeps the newest
+  SpscQueue<EchoSample, 4> queue;
+  std::unique_ptr<EchoDemux<ULTRASONIC_MAX_SENSORS>> slot(new EchoDemux<ULTRASONIC_MAX_SENSORS>());
+  uint32_t queueMaxAge = 0, slotMaxAge = 0;
+  for (uint32_t echoUs = 3500, pollUs = 50000; pollUs <= 10000000; echoUs += 3500) {
+    for (; pollUs <= echoUs; pollUs += 50000) {
+      EchoSample newest = {0, 0}, sample;
+      while (queue.pop(sample)) newest = sample;
+      queueMaxAge = std::max(queueMaxAge, pollUs - newest.timeUs);
+      if (slot->latest(0, sample)) slotMaxAge = std::max(slotMaxAge, pollUs - sample.timeUs);
+    }
+    const EchoSample echo = {echoUs, 580};
+    queue.push(echo);
+    slot->arm(1);
+    slot->onEdge(0, true, echoUs - 580);
+    slot->onEdge(0, false, echoUs);
+  }
+  printf("[ultrasonic] distance age at a 50 ms poll: 4-deep queue up to %.1f ms, newest-echo slot up to %.1f ms\n",
+         queueMaxAge / 1000.0, slotMaxAge / 1000.0);
+
+  static EchoDemux<ULTRASONIC_MAX_SENSORS> demux;
+  EchoSample sample;
+  const double cycles = bench_cycles_per_call(1000000, [&](uint32_t i) {
+    const uint8_t sensor = i & 7;
+    if (sensor == 0) demux.arm(0xff);
+    demux.onEdge(sensor, true, i * 10);
+    demux.onEdge(sensor, false, i * 10 + 5800);
+    demux.latest(sensor, sample);
+  });
+  printf("[ultrasonic] demux: %.1f cycles per echo (two edges and a read)\n", cycles);
+}
+
+// Nine control jobs shaped like the firmware's ControlSchedule
+volatile uint32_t jobRuns[9];
+void job0() { jobRuns[0]++; }
+void job1() { jobRuns[1]++; }
+void job2() { jobRuns[2]++; }
+void job3() { jobRuns[3]++; }
+void job4() { jobRuns[4]++; }
+void job5() { jobRuns[5]++; }
+void job6() { jobRuns[6]++; }
+void job7() { jobRuns[7]++; }
+void job8() { jobRuns[8]++; }
+
+using BenchSchedule = StaticSchedule<5,
+  PeriodicJob<job0, 5, 0, 700>, PeriodicJob<job1, 5, 0, 150>, PeriodicJob<job2, 5, 0, 20>,
+  PeriodicJob<job3, 5, 0, 80>, PeriodicJob<job4, 50, 0, 300>, PeriodicJob<job5, 100, 5, 400>,
+  PeriodicJob<job6, 100, 10, 250>, PeriodicJob<job7, 2000, 15, 250>, PeriodicJob<job8, 5000, 20, 300>>;
+
+// The pattern it replaces: a last-run timestamp per job, compared every tick
+// through a table of function pointers
+struct TimedJob {
+  void (*fn)();
+  uint32_t periodMs;
+  uint32_t lastMs;
+};
+
+void bench_schedule() {
+  TimedJob table[] = {
+    {job0, 5, 0}, {job1, 5, 0}, {job2, 5, 0}, {job3, 5, 0}, {job4, 50, 0},
+    {job5, 100, 0}, {job6, 100, 0}, {job7, 2000, 0}, {job8, 5000, 0},
+  };
+  const uint32_t ticks = 10000000;
+
+  const double tableCycles = bench_cycles_per_call(ticks, [&](uint32_t tick) {
+    const uint32_t nowMs = tick * 5;
+    for (TimedJob &job : table) {
+      if (nowMs - job.lastMs >= job.periodMs) {
+        job.lastMs = nowMs;
+        job.fn();
+      }
+    }
+  });
+  const uint32_t tableRuns = jobRuns[8];
+
+  const double staticCycles = bench_cycles_per_call(ticks, [](uint32_t tick) { BenchSchedule::run(tick); });
+
+  printf("[schedule] %zu jobs, hyperperiod %u ms, worst tick %u us, average %u us of job budget\n",
+         BenchSchedule::jobCount, BenchSchedule::hyperperiodMs(),
+         BenchSchedule::worstTickBudgetUs(), BenchSchedule::averageTickBudgetUs());
+  printf("[schedule] timestamp table %.1f cycles per tick, static schedule %.1f cycles per tick\n",
+         tableCycles, staticCycles);
+  printf("[schedule] slowest job ran %u times (table) and %u times (static) in %u ticks\n",
+         tableRuns, jobRuns[8] - tableRuns, ticks);
+}
+
+// GPS time for a device clock running 35 ppm fast. Each second the module
+// sends GGA then RMC for the second that just started, 50 ms plus up to
+// 100 ms of jitter late, and the '$' stamp lags by up to one 5 ms control
+// tick. After an hour the GPS is lost to test holdover.
+struct ClockRun {
+  double errorP50Us;
+  double errorP99Us;
+  double errorMaxUs;
+  double holdoverErrorUs;   // 10 minutes after the last reference
+  double driftPpm;
+};
+
+ClockRun simulate_clock(bool filtered) {
+  const double crystalPpm = 35.0;
+  const int64_t latencyUs = 50000;
+  const int gpsSeconds = 3600;
+  auto mono = [&](int64_t utcUs) { return (int64_t)(utcUs * (1.0 + crystalPpm * 1e-6)); };
+
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<int64_t> jitter(0, 100000), lag(0, 5000);
+  // Unfiltered: every sentence is a reference, as if the window held one sentence
+  ClockDiscipline clock(filtered ? 60000000 : 1, 120000000, 500000, 10000, 50000, latencyUs);
+  const int64_t epoch = 1700000000LL * 1000000;
+  std::vector<double> errors;
+
+  for (int second = 1; second <= gpsSeconds; second++) {
+    const int64_t utc = (int64_t)second * 1000000;
+    const int64_t gga = utc + latencyUs + jitter(rng);
+    clock.addGps(mono(gga) + lag(rng), epoch + utc);
+    clock.addGps(mono(gga + 40000) + lag(rng), epoch + utc);
+    if (second > 600) {
+      const int64_t probe = utc + 500000;
+      errors.push_back((double)std::llabs(clock_to_utc(clock.model(), mono(probe)) - (epoch + probe)));
+    }
+  }
+  std::sort(errors.begin(), errors.end());
+  const int64_t holdover = (int64_t)(gpsSeconds + 600) * 1000000;
+
+  ClockRun run;
+  run.errorP50Us = errors[errors.size() / 2];
+  run.errorP99Us = errors[errors.size() * 99 / 100];
+  run.errorMaxUs = errors.back();
+  run.holdoverErrorUs = (double)std::llabs(clock_to_utc(clock.model(), mono(holdover)) - (epoch + holdover));
+  run.driftPpm = clock.model().driftPpb / 1000.0;
+  return run;
+}
+
+void bench_clock() {
+  const ClockRun filtered = simulate_clock(true);
+  const ClockRun raw = simulate_clock(false);
+  printf("[clock] 35 ppm crystal, NMEA 50 ms + 0-100 ms late: UTC error p50 %.2f ms, p99 %.2f ms, max %.2f ms,"
+         " drift estimate %.2f ppm (true %.2f)\n",
+         filtered.errorP50Us / 1000, filtered.errorP99Us / 1000, filtered.errorMaxUs / 1000,
+         filtered.driftPpm, -35.0 / 1.000035);
+  printf("[clock] every sentence as a reference: p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+         raw.errorP50Us / 1000, raw.errorP99Us / 1000, raw.errorMaxUs / 1000);
+  printf("[clock] 10 minutes without GPS: error %.2f ms (%.1f ms without drift correction)\n",
+         filtered.holdoverErrorUs / 1000, 600 * 35e-3);
+
+  ClockDiscipline clock(60000000, 120000000, 500000, 10000, 50000, 0);
+  const double cycles = bench_cycles_per_call(2000000, [&](uint32_t i) {
+    clock.addGps((int64_t)i * 500000 + (i * 7919) % 300000, (int64_t)(i / 2) * 1000000);
+  });
+  ClockModel model = clock.model();
+  const double convertCycles = bench_cycles_per_call(2000000, [&](uint32_t i) {
+    bench_keep(clock_to_utc(model, (int64_t)i * 1000));
+  });
+  printf("[clock] %.1f cycles per GPS sentence, %.1f cycles per UTC conversion\n", cycles, convertCycles);
+}
+
+// Eight hours of driving through WiFi dead zones (coverage for 2-40 minutes,
+// then 10-120 s without). A fast attempt associates in 0.6 s of coverage if
+// the vehicle is back on the same access point (80% of the time), otherwise
+// it never does; a scan with DHCP takes 4 s of coverage.
+struct LinkRun {
+  double upPercent;
+  uint32_t drops;
+  uint32_t reconnects;
+  double meanOutageMs;
+  double meanRecoveryMs;    // Coverage back to connected
+  uint32_t maxRecoveryMs;
+};
+
+LinkRun simulate_link(bool manager, bool useCache) {
+  const uint32_t stepMs = 100, durationMs = 8 * 3600 * 1000;
+  std::mt19937 rng(5), apRng(9);   // Same dead zones in every run
+  std::uniform_int_distribution<uint32_t> coveredMs(120000, 2400000), deadMs(10000, 120000);
+  std::uniform_int_distribution<int> percent(0, 99);
+
+  LinkManager link(3000, 15000, 2000, 15000);
+  link.seed(42);
+  bool coverage = true, associated = false, associating = false;
+  int32_t remainingMs = 0;
+  uint32_t zoneEndMs = coveredMs(rng), upMs = 0, coverageBackMs = 0;
+  uint64_t recoveryMs = 0;
+  uint32_t recoveries = 0;
+  LinkRun run = {};
+
+  // The boot connection, as the old blocking connect_wifi() made it
+  if (!manager) {
+    associating = true;
+    remainingMs = 4000;
+  }
+  for (uint32_t now = 0; now < durationMs; now += stepMs) {
+    if (now >= zoneEndMs) {
+      coverage = !coverage;
+      zoneEndMs = now + (coverage ? coveredMs(rng) : deadMs(rng));
+      if (!coverage) associated = false;
+      coverageBackMs = now;
+    }
+    if (associating && coverage && remainingMs > 0) {
+      remainingMs -= stepMs;
+      if (remainingMs <= 0) {
+        associated = true;
+        associating = false;
+        if (coverageBackMs > 0) {
+          const uint32_t recovery = now - coverageBackMs;
+          recoveryMs += recovery;
+          recoveries++;
+          run.maxRecoveryMs = std::max(run.maxRecoveryMs, recovery);
+        }
+      }
+    }
+    if (associated) upMs += stepMs;
+    if (!manager) continue;
+
+    switch (link.update(now, associated, useCache && link.stats().scanConnects > 0)) {
+      case LINK_ACTION_CONNECT_FAST:
+        associating = true;
+        remainingMs = percent(apRng) < 80 ? 600 : INT32_MAX;
+        break;
+      case LINK_ACTION_CONNECT_SCAN:
+        associating = true;
+        remainingMs = 4000;
+        break;
+      case LINK_ACTION_ABORT:
+        associating = false;
+        break;
+      case LINK_ACTION_NONE:
+        break;
+    }
+  }
+  const LinkStats &stats = link.stats();
+  run.upPercent = 100.0 * upMs / durationMs;
+  run.drops = stats.drops;
+  run.reconnects = stats.reconnects;
+  run.meanOutageMs = stats.reconnects ? (double)stats.totalOutageMs / stats.reconnects : 0;
+  run.meanRecoveryMs = recoveries ? (double)recoveryMs / recoveries : 0;
+  return run;
+}
+
+void bench_link() {
+  const LinkRun once = simulate_link(false, false);
+  printf("[link] 8 h through dead zones: connect once at boot %.1f%% up\n", once.upPercent);
+  for (bool cache : {false, true}) {
+    const LinkRun run = simulate_link(true, cache);
+    printf("[link] reconnect %s: %.1f%% up, %u drops, %u reconnects, outage mean %.1f s |"
+           " coverage back to connected mean %.1f s, max %.1f s\n",
+           cache ? "with fast cache" : "with scan only", run.upPercent, run.drops, run.reconnects,
+           run.meanOutageMs / 1000, run.meanRecoveryMs / 1000, run.maxRecoveryMs / 1000.0);
+  }
+}
+
+// Bus time of one transaction: address, write and read bytes at 9 clocks each,
+// plus start/stop and a repeated start before a read
+uint32_t i2c_bus_us(uint32_t clockHz, uint32_t writeBytes, uint32_t readBytes) {
+  const uint32_t bits = (1 + writeBytes) * 9 + (readBytes ? (1 + readBytes) * 9 + 2 : 0) + 2;
+  return bits * 1000000u / clockHz + 20;   // 20 us of driver overhead
+}
+
+struct I2cRun {
+  double meanWaitUs;
+  uint32_t maxWaitUs;
+  uint32_t late;          // IMU reads later than the 2 ms the control loop waits
+  uint64_t lcdBytes;
+};
+
+// A minute of 100 Hz IMU reads while the LCD text changes every 500 ms.
+// Before: LiquidCrystal_I2C redraws with clear() and two print()s in one go,
+// a transmission per expander write, with the IMU read waiting behind all of
+// it. After: the shadow sends only the changed cells, each a transaction the
+// scheduler may put the IMU read in front of.
+I2cRun simulate_i2c(bool scheduled) {
+  static const char *const texts[][2] = {
+    {"Speed: 42 km/h", "Dist: 180 cm"}, {"Speed: 43 km/h", "Dist: 176 cm"},
+    {"Speed: 45 km/h", "Dist: 171 cm"}, {"HR: 72 BPM", "Alcohol: 120"},
+  };
+  const uint32_t imuUs = i2c_bus_us(400000, 1, 14);
+  const uint32_t expanderUs = i2c_bus_us(100000, 1, 0);   // One expander write
+  const uint32_t endUs = 60000000;
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<uint32_t> jitter(0, 500);
+
+  I2cRun run = {};
+  uint64_t waitSum = 0;
+  uint32_t reads = 0;
+  uint32_t busFreeUs = 0;
+  uint32_t nextImuUs = 0;
+  uint32_t nextTextUs = 250000;
+  size_t text = 0;
+
+  LcdShadow<16, 2> shadow;
+  std::unique_ptr<I2cScheduler<2, 16>> scheduler(new I2cScheduler<2, 16>());
+  I2cScheduler<2, 16> &bus = *scheduler;
+  uint32_t imuQueuedUs = 0;
+
+  while (nextImuUs < endUs) {
+    if (!scheduled) {
+      // The next thing to happen: a redraw or a read, each blocking the bus
+      if (nextTextUs < nextImuUs) {
+        const uint32_t start = std::max(nextTextUs, busFreeUs);
+        uint32_t writes = 4 + 4;   // clear() and the home cursor move
+        for (const char *line : texts[text]) writes += 4 + 4 * (uint32_t)strlen(line);
+        busFreeUs = start + writes * expanderUs + 2000;   // clear() waits 2 ms
+        run.lcdBytes += writes;
+        text = (text + 1) % 4;
+        nextTextUs += 500000;
+        continue;
+      }
+      const uint32_t start = std::max(nextImuUs, busFreeUs);
+      const uint32_t wait = start - nextImuUs;
+      waitSum += wait;
+      reads++;
+      if (wait > run.maxWaitUs) run.maxWaitUs = wait;
+      if (wait + imuUs > 2000) run.late++;
+      busFreeUs = start + imuUs;
+      nextImuUs += 10000 + jitter(rng);
+      continue;
+    }
+
+    // Scheduled: producers queue work due by the time the bus frees up
+    const uint32_t now = busFreeUs;
+    if (nextTextUs <= now) {
+      shadow.set(0, texts[text][0]);
+      shadow.set(1, texts[text][1]);
+      text = (text + 1) % 4;
+      nextTextUs += 500000;
+    }
+    if (nextImuUs <= now && imuQueuedUs == 0) {
+      I2cTransaction txn = {};
+      txn.readLength = 14;
+      bus.submit(0, txn, nextImuUs);
+      imuQueuedUs = nextImuUs;
+    }
+    I2cTransaction cell = {};
+    size_t row, col;
+    while ((cell.writeLength = shadow.nextUpdate(cell.data, row, col)) != 0 && bus.submit(1, cell, now)) {
+      shadow.commit(row, col);
+    }
+
+    I2cTransaction txn;
+    size_t level;
+    if (!bus.next(txn, level)) {
+      busFreeUs = std::min(nextImuUs, nextTextUs);
+      continue;
+    }
+    if (level == 0) {
+      const uint32_t wait = now - imuQueuedUs;
+      waitSum += wait;
+      reads++;
+      if (wait > run.maxWaitUs) run.maxWaitUs = wait;
+      if (wait + imuUs > 2000) run.late++;
+      busFreeUs = now + imuUs;
+      imuQueuedUs = 0;
+      nextImuUs += 10000 + jitter(rng);
+    } else {
+      busFreeUs = now + i2c_bus_us(100000, txn.writeLength, 0);
+      run.lcdBytes += txn.writeLength;
+    }
+    const uint8_t data[I2C_MAX_READ] = {};
+    bus.completed(level, txn, now, busFreeUs, 0, data);
+    I2cResult result;
+    bus.result(level, result);
+  }
+  run.meanWaitUs = reads ? (double)waitSum / reads : 0;
+  return run;
+}
+
+void bench_i2c() {
+  for (bool scheduled : {false, true}) {
+    const I2cRun run = simulate_i2c(scheduled);
+    printf("[i2c] %s: IMU read queued behind the LCD mean %.0f us, max %u us, %u reads over 2 ms |"
+           " LCD %llu expander bytes/min\n",
+           scheduled ? "prioritised, shadow diff" : "shared Wire, full redraw", run.meanWaitUs,
+           run.maxWaitUs, run.late, (unsigned long long)run.lcdBytes);
+  }
+
+  static I2cScheduler<2, 16> bus;
+  I2cTransaction txn = {};
+  I2cResult result;
+  const uint8_t data[I2C_MAX_READ] = {};
+  size_t level = 0;
+  const double cycles = bench_cycles_per_call(1000000, [&](uint32_t i) {
+    bus.submit(i & 1, txn, i);
+    bus.next(txn, level);
+    txn.readLength = i & 1 ? 0 : 14;
+    bus.completed(level, txn, i, i + 300, 0, data);
+    bus.result(level, result);
+  });
+  printf("[i2c] scheduler: %.1f cycles per transaction (submit, next, completed, result)\n", cycles);
+}
+
+// Shapes of MQ-3 readings (ADC counts at 100 ms): a cold heater decaying
+// after power-on, clean-air drift, cabin heating, and a driver who has been
+// drinking, the alcohol arriving in seconds or building up over many minutes
+struct AlcoholCurve {
+  const char *name;
+  uint32_t durationS;
+  float coldStart;     // Extra reading at power-on, decaying over ~8 s
+  float driftPerMin;   // Clean-air drift
+  float cabinRiseC;    // Cabin warming from 20 C over the run
+  float exposureAtS;   // When the alcohol arrives, < 0 for never
+  float exposure;      // Rise it causes
+  float rampPerMin;    // 0: the rise settles within seconds, else it builds up linearly
+  float detectWithinS; // The pipeline must detect it this soon after it arrives
+};
+
+struct AlcoholRun {
+  uint32_t fixedAlarmMs;     // ALCOHOL_THRESHOLD on the raw reading
+  uint32_t pipelineAlarmMs;  // Time in ALCOHOL_DETECTED
+  int32_t fixedFirstS;       // First alarm, -1 for none
+  int32_t pipelineFirstS;
+};
+
+AlcoholRun simulate_alcohol(const AlcoholCurve &curve) {
+  std::mt19937 rng(11);
+  std::normal_distribution<float> noise(0.0f, 12.0f);
+  AlcoholPipeline pipeline(alcohol_config());
+  AlcoholRun run = {0, 0, -1, -1};
+  for (uint32_t ms = 0; ms < curve.durationS * 1000; ms += 100) {
+    const float t = ms / 1000.0f;
+    const float cabinC = 20.0f + curve.cabinRiseC * t / curve.durationS;
+    float air = 260.0f + curve.driftPerMin * t / 60.0f;
+    if (curve.exposureAtS >= 0 && t >= curve.exposureAtS) {
+      const float since = t - curve.exposureAtS;
+      air += curve.rampPerMin > 0 ? std::fmin(curve.exposure, curve.rampPerMin * since / 60.0f)
+                                  : curve.exposure * (1.0f - std::exp(-since / 5.0f));
+    }
+    const float raw = air * (1.0f + ALCOHOL_TEMP_COEFF * (cabinC - ALCOHOL_REF_TEMP)) +
+                      curve.coldStart * std::exp(-t / 8.0f) + noise(rng);
+    const int reading = (int)std::fmin(std::fmax(raw, 0.0f), 4095.0f);
+    if (is_alcohol_detected(reading)) {
+      run.fixedAlarmMs += 100;
+      if (run.fixedFirstS < 0) run.fixedFirstS = (int32_t)t;
+    }
+    if (pipeline.update(ms, reading, cabinC) == ALCOHOL_DETECTED) {
+      run.pipelineAlarmMs += 100;
+      if (run.pipelineFirstS < 0) run.pipelineFirstS = (int32_t)t;
+    }
+  }
+  return run;
+}
+
+void bench_alcohol() {
+  static const AlcoholCurve curves[] = {
+    {"cold start, clean air", 600, 1200.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f},
+    {"hot cabin, clean air", 600, 600.0f, 0.0f, 45.0f, -1.0f, 0.0f, 0.0f, 0.0f},
+    {"baseline drifting up", 3600, 600.0f, 1.5f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f},
+    {"drinks after 5 min", 600, 600.0f, 0.0f, 10.0f, 300.0f, 220.0f, 0.0f, 15.0f},
+    // Alcohol present from power-on is only decided once warm-up ends
+    {"drunk at boot", 600, 600.0f, 0.0f, 0.0f, 0.0f, 400.0f, 0.0f, 45.0f},
+    // 150 counts of rise take 25 min; the absolute threshold trips after 40
+    {"slow exposure", 2700, 600.0f, 0.0f, 0.0f, 60.0f, 300.0f, 6.0f, 1900.0f},
+  };
+  for (const AlcoholCurve &curve : curves) {
+    const AlcoholRun run = simulate_alcohol(curve);
+    printf("[alcohol] %-22s fixed threshold: alarm %5.1f s (first at %4d s) | pipeline: alarm %5.1f s (first at %4d s)\n",
+           curve.name, run.fixedAlarmMs / 1000.0, run.fixedFirstS, run.pipelineAlarmMs / 1000.0, run.pipelineFirstS);
+    char what[96];
+    if (curve.exposureAtS < 0) {
+      snprintf(what, sizeof(what), "alcohol: false alarm on \"%s\"", curve.name);
+      check(run.pipelineFirstS < 0, what);
+    } else {
+      snprintf(what, sizeof(what), "alcohol: \"%s\" not detected within %.0f s", curve.name, curve.detectWithinS);
+      check(run.pipelineFirstS >= 0 && run.pipelineFirstS <= curve.exposureAtS + curve.detectWithinS, what);
+    }
+  }
+
+  AlcoholPipeline pipeline(alcohol_config());
+  const double cycles = bench_cycles_per_call(1000000, [&](uint32_t i) {
+    bench_keep(pipeline.update(i * 100, 300 + (int)(i & 63), 25.0f));
+  });
+  printf("[alcohol] pipeline: %.1f cycles per sample\n", cycles);
+}
+
+struct Benchmark {
+  const char *name;
+  void (*run)();
+};
+
+const Benchmark kBenchmarks[] = {
+  {"fast_math", bench_fast_math},
+  {"orientation", bench_orientation},
+  {"vibration", bench_vibration},
+  {"seqlock", bench_seqlock},
+  {"track", bench_track},
+  {"ultrasonic", bench_ultrasonic},
+  {"schedule", bench_schedule},
+  {"clock", bench_clock},
+  {"link", bench_link},
+  {"i2c", bench_i2c},
+  {"alcohol", bench_alcohol},
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int ran = 0;
+  for (const Benchmark &b : kBenchmarks) {
+    bool selected = argc < 2;
+    for (int i = 1; i < argc; i++) {
+      if (std::strcmp(argv[i], b.name) == 0) selected = true;
+    }
+    if (selected) {
+      b.run();
+      ran++;
+    }
+  }
+  if (ran == 0) {
+    fprintf(stderr, "usage: %s [benchmark...]\n", argv[0]);
+    for (const Benchmark &b : kBenchmarks) fprintf(stderr, "  %s\n", b.name);
+    return 1;
+  }
+  if (checkFailures > 0) {
+    printf("%d check(s) failed\n", checkFailures);
+    return 1;
+  }
+  return 0;
+}
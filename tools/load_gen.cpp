@@ -0,0 +1,869 @@
+// Fleet load generator for the telemetry ingest (/api/sensor). Each virtual
+// device builds its POST with write_telemetry_payload(), the same builder
+// send_to_backend() uses, from its own simulated sensors, histories and
+// MAC-style device_id, and posts every BACKEND_UPDATE_INTERVAL with jitter.
+// All devices share one epoll loop, so thousands run from one thread.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -Iinclude tools/load_gen.cpp -o load_gen -pthread
+//   ./load_gen --local --devices 2000 --duration 60     # against the built-in stand-in server
+//   ./load_gen --url http://localhost:5000/api/sensor --devices 5000
+//   ./load_gen --serve 8081                             # only the stand-in server
+//
+// Options:
+//   --devices N      virtual devices (100)
+//   --duration S     seconds of load, after which in-flight requests drain (30)
+//   --interval MS    post period per device (5000, BACKEND_UPDATE_INTERVAL)
+//   --jitter PCT     +- spread of each period (10)
+//   --timeout MS     per request, connect included (10000)
+//   --close          new connection per request instead of keep-alive
+//   --service-ms MS  stand-in server's processing time per request (0)
+//
+// Plain HTTP only; put a TLS-terminating proxy in front for https endpoints.
+// Thousands of devices need as many sockets: the open-file limit is raised
+// to its hard maximum.
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "telemetry_payload.h"
+#include "vibration_features.h"
+
+namespace {
+
+#define BACKEND_UPDATE_INTERVAL 5000   // Must match main.cpp
+#define MIN_BPM 50
+#define MAX_BPM 180
+#define EMERGENCY_CONTACT_COUNT 2
+
+struct Options {
+  std::string host = "127.0.0.1";
+  std::string port = "5000";
+  std::string path = "/api/sensor";
+  int devices = 100;
+  int durationS = 30;
+  int intervalMs = BACKEND_UPDATE_INTERVAL;
+  int jitterPct = 10;
+  int timeoutMs = 10000;
+  bool keepAlive = true;
+  bool local = false;
+  int servePort = 0;
+  int serviceMs = 0;
+};
+
+uint64_t now_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t utc_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void raise_fd_limit() {
+  rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+
+// Header block of an HTTP message: status code (responses), Content-Length,
+// chunked and Connection: close. Returns false until the block is complete.
+struct HttpHead {
+  size_t bodyStart = 0;
+  int status = 0;
+  long contentLength = -1;
+  bool chunked = false;
+  bool close = false;
+};
+
+bool header_is(const char *line, const char *name) { return strncasecmp(line, name, strlen(name)) == 0; }
+
+bool parse_head(const std::string &buffer, HttpHead &head) {
+  const size_t end = buffer.find("\r\n\r\n");
+  if (end == std::string::npos) return false;
+  head = HttpHead();
+  head.bodyStart = end + 4;
+  if (buffer.compare(0, 5, "HTTP/") == 0) {
+    const size_t space = buffer.find(' ');
+    if (space != std::string::npos && space < end) head.status = atoi(buffer.c_str() + space + 1);
+  }
+  size_t line = buffer.find("\r\n") + 2;
+  while (line < end) {
+    const size_t next = buffer.find("\r\n", line);
+    const std::string text = buffer.substr(line, next - line);
+    if (header_is(text.c_str(), "Content-Length:")) {
+      head.contentLength = atol(text.c_str() + 15);
+    } else if (header_is(text.c_str(), "Transfer-Encoding:")) {
+      head.chunked = text.find("chunked") != std::string::npos;
+    } else if (header_is(text.c_str(), "Connection:")) {
+      head.close = strcasestr(text.c_str(), "close") != nullptr;
+    }
+    line = next + 2;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Stand-in server: accepts the POSTs, checks each body looks like a telemetry
+// document and answers 200 after the configured service time.
+
+class StandInServer {
+ public:
+  // Listens on 127.0.0.1:port (0 picks a free port)
+  bool start(int port, int serviceMs) {
+    serviceUs_ = (uint64_t)serviceMs * 1000;
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    int one = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listenFd_, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenFd_, 4096) != 0) {
+      perror("stand-in server");
+      return false;
+    }
+    socklen_t length = sizeof(addr);
+    getsockname(listenFd_, (sockaddr *)&addr, &length);
+    port_ = ntohs(addr.sin_port);
+    epollFd_ = epoll_create1(0);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &event);
+    thread_ = std::thread([this] { run(); });
+    return true;
+  }
+
+  void stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+    close(listenFd_);
+    close(epollFd_);
+  }
+
+  int port() const { return port_; }
+  uint64_t requests() const { return requests_.load(); }
+  uint64_t badPayloads() const { return badPayloads_.load(); }
+  uint64_t bytes() const { return bytes_.load(); }
+
+ private:
+  struct Connection {
+    uint64_t id = 0;       // fds are reused; delayed replies must find the same connection
+    std::string in;
+    std::string out;
+    bool closeAfter = false;
+  };
+
+  struct Reply {
+    uint64_t dueUs;
+    int fd;
+    uint64_t connectionId;
+    std::string response;
+    bool close;
+  };
+
+  void run() {
+    std::vector<epoll_event> events(1024);
+    while (running_) {
+      const int n = epoll_wait(epollFd_, events.data(), (int)events.size(), serviceUs_ ? 1 : 50);
+      for (int i = 0; i < n; i++) {
+        const int fd = events[i].data.fd;
+        if (fd == listenFd_) {
+          accept_all();
+          continue;
+        }
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) readable(fd);
+        if (connections_.count(fd) && (events[i].events & EPOLLOUT)) flush(fd);
+      }
+      const uint64_t now = now_us();
+      while (!delayed_.empty() && delayed_.front().dueUs <= now) {
+        Reply &reply = delayed_.front();
+        auto it = connections_.find(reply.fd);
+        if (it != connections_.end() && it->second.id == reply.connectionId) {
+          it->second.out += reply.response;
+          it->second.closeAfter |= reply.close;
+          flush(reply.fd);
+        }
+        delayed_.pop_front();
+      }
+    }
+    for (auto &connection : connections_) close(connection.first);
+  }
+
+  void accept_all() {
+    while (true) {
+      const int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK);
+      if (fd < 0) return;
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      connections_[fd].id = ++nextConnectionId_;
+      epoll_event event = {};
+      event.events = EPOLLIN;
+      event.data.fd = fd;
+      epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event);
+    }
+  }
+
+  void readable(int fd) {
+    Connection &connection = connections_[fd];
+    char buffer[16384];
+    while (true) {
+      const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+      if (n > 0) {
+        connection.in.append(buffer, n);
+        continue;
+      }
+      if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        drop(fd);
+        return;
+      }
+      break;
+    }
+
+    HttpHead head;
+    while (parse_head(connection.in, head)) {
+      const size_t length = head.contentLength > 0 ? (size_t)head.contentLength : 0;
+      if (connection.in.size() < head.bodyStart + length) break;
+      const char *body = connection.in.c_str() + head.bodyStart;
+      const bool good = length > 2 && body[0] == '{' && body[length - 1] == '}' &&
+                        memmem(body, length, "\"device_id\"", 11) != nullptr;
+      requests_++;
+      bytes_ += length;
+      if (!good) badPayloads_++;
+      const char *reply = good ? "{\"status\":\"ok\"}" : "{\"error\":\"invalid payload\"}";
+      char response[256];
+      snprintf(response, sizeof(response),
+               "HTTP/1.1 %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n%s\r\n%s",
+               good ? "200 OK" : "400 Bad Request", strlen(reply), head.close ? "Connection: close\r\n" : "",
+               reply);
+      connection.in.erase(0, head.bodyStart + length);
+      if (serviceUs_) {
+        delayed_.push_back({now_us() + serviceUs_, fd, connection.id, response, head.close});
+      } else {
+        connection.out += response;
+        connection.closeAfter |= head.close;
+      }
+    }
+    flush(fd);
+  }
+
+  void flush(int fd) {
+    Connection &connection = connections_[fd];
+    while (!connection.out.empty()) {
+      const ssize_t n = send(fd, connection.out.data(), connection.out.size(), MSG_NOSIGNAL);
+      if (n <= 0) break;
+      connection.out.erase(0, n);
+    }
+    if (connection.out.empty() && connection.closeAfter) {
+      drop(fd);
+      return;
+    }
+    epoll_event event = {};
+    event.events = EPOLLIN | (connection.out.empty() ? 0u : (uint32_t)EPOLLOUT);
+    event.data.fd = fd;
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &event);
+  }
+
+  void drop(int fd) {
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections_.erase(fd);
+  }
+
+  int listenFd_ = -1;
+  int epollFd_ = -1;
+  int port_ = 0;
+  uint64_t serviceUs_ = 0;
+  std::atomic<bool> running_{true};
+  std::thread thread_;
+  std::unordered_map<int, Connection> connections_;
+  uint64_t nextConnectionId_ = 0;
+  std::deque<Reply> delayed_;   // Constant service time keeps this in due order
+  std::atomic<uint64_t> requests_{0};
+  std::atomic<uint64_t> badPayloads_{0};
+  std::atomic<uint64_t> bytes_{0};
+};
+
+// ---------------------------------------------------------------------------
+// Virtual devices
+
+// One vehicle's sensors, evolving between posts like the firmware's state
+struct VirtualVehicle {
+  char deviceId[18];
+  std::mt19937 rng;
+  SensorHistory history = {};
+  PulseData pulseData[PULSE_DATA_POINTS] = {};
+  int pulseDataIndex = 0;
+  float vibrationBands[VIBRATION_BANDS] = {};
+  AlertReport alert = {};
+  LinkStats link = {};
+  uint32_t uptimeMs = 0;
+  float distance = 150, alcohol = 260, pulse = 72, speed = 40, roll = 0, pitch = 0;
+  float lat = 5.6037f, lng = -0.1870f;
+  bool drinking = false;
+
+  VirtualVehicle(uint32_t index, uint32_t seed) : rng(seed) {
+    // Espressif OUI, the rest from the index, as WiFi.macAddress() formats it
+    snprintf(deviceId, sizeof(deviceId), "24:6F:28:%02X:%02X:%02X", (index >> 16) & 0xff, (index >> 8) & 0xff,
+             index & 0xff);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    drinking = unit(rng) < 0.02f;
+    lat += (unit(rng) - 0.5f) * 0.2f;
+    lng += (unit(rng) - 0.5f) * 0.2f;
+    uptimeMs = (uint32_t)(unit(rng) * 3600000);
+    // Steady state: full histories and a full minute of pulse readings
+    for (int i = 0; i < HISTORY_SIZE; i++) step(100);
+    for (int i = 0; i < PULSE_DATA_POINTS; i++) {
+      pulseData[i] = {(unsigned long)(uptimeMs - (PULSE_DATA_POINTS - i) * 1000), (int)pulse};
+    }
+    if (unit(rng) < 0.005f) {
+      alert = {1, 2, 35, 2400, {2400, 3100, 9000, 180}};   // Two SMS, the call, the backend
+    }
+    link.drops = (uint32_t)(unit(rng) * 4);
+    link.reconnects = link.drops;
+    link.lastOutageMs = link.drops ? 2000 + (uint32_t)(unit(rng) * 8000) : 0;
+    link.maxOutageMs = link.lastOutageMs;
+  }
+
+  // Advances the sensors by dtMs and records a history sample
+  void step(uint32_t dtMs) {
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    uptimeMs += dtMs;
+    distance = std::fmin(std::fmax(distance + 15.0f * noise(rng), 10.0f), 400.0f);
+    alcohol = (drinking ? 620.0f : 260.0f) + 15.0f * noise(rng);
+    pulse = std::fmin(std::fmax(pulse + 2.0f * noise(rng), MIN_BPM), 120.0f);
+    speed = std::fmin(std::fmax(speed + 3.0f * noise(rng), 0.0f), 110.0f);
+    roll = 2.0f * noise(rng);
+    pitch = 2.0f * noise(rng);
+    lat += 0.0001f * noise(rng);
+    lng += 0.0001f * noise(rng);
+    for (int b = 0; b < VIBRATION_BANDS; b++) vibrationBands[b] = 40.0f / (b + 1) + 5.0f * std::fabs(noise(rng));
+
+    history.distance[history.index] = (long)distance;
+    history.alcohol[history.index] = (int)alcohol;
+    history.impact[history.index] = 1.0f + 0.05f * noise(rng);
+    history.pulse[history.index] = (int)pulse;
+    history.vibration[history.index] = 1800 + (int)(60 * noise(rng));
+    history.index = (history.index + 1) % HISTORY_SIZE;
+  }
+
+  // The document send_to_backend() would post now
+  size_t payload(char *buffer, size_t capacity, uint32_t intervalMs) {
+    step(intervalMs);
+    if (uptimeMs / 5000 != (uptimeMs - intervalMs) / 5000) {
+      pulseData[pulseDataIndex] = {uptimeMs, (int)pulse};
+      pulseDataIndex = (pulseDataIndex + 1) % PULSE_DATA_POINTS;
+    }
+
+    const int64_t utc = utc_us();
+    char timestamp[25];
+    snprintf(timestamp, sizeof(timestamp), "%lld", (long long)(utc / 1000));
+    char lcd[48];
+    snprintf(lcd, sizeof(lcd), "D%d A%d I1.0 | HR:%d H%d", (int)distance, (int)alcohol, (int)pulse, (int)pulse);
+    const int newest = (history.index - 1 + HISTORY_SIZE) % HISTORY_SIZE;
+
+    TelemetryPayload p = {};
+    p.deviceId = deviceId;
+    p.timestamp = timestamp;
+    p.timeSource = "gps";
+    p.clockValid = true;
+    p.utcUs = utc - 40000;
+    p.sentUtcUs = utc;
+    p.clockUncertaintyUs = 10000;
+    p.alcohol = (int)alcohol;
+    p.alcoholState = drinking ? "detected" : "clear";
+    p.vibration = history.vibration[newest];
+    p.vibrationRms = 35.0f;
+    p.roadCondition = ROAD_SMOOTH;
+    p.vibrationBands = vibrationBands;
+    p.vibrationBandCount = VIBRATION_BANDS;
+    p.distance = (long)distance;
+    p.seatbelt = true;
+    p.impact = history.impact[newest];
+    p.pulse = (int)pulse;
+    p.roll = roll;
+    p.pitch = pitch;
+    p.speed = speed;
+    p.lcdDisplay = lcd;
+    p.gpsValid = true;
+    p.lat = lat;
+    p.lng = lng;
+    p.satellites = 8;
+    p.alert = &alert;
+    p.smsChannels = EMERGENCY_CONTACT_COUNT;
+    p.link = &link;
+    p.linkUptimePct = 99.2f;
+    p.rssi = -60 - (int)(rng() % 25);
+    p.pulseMin = MIN_BPM;
+    p.pulseMax = MAX_BPM;
+    p.pulseData = pulseData;
+    p.pulseDataIndex = pulseDataIndex;
+    p.history = &history;
+    return write_telemetry_payload(p, buffer, capacity);
+  }
+};
+
+enum DeviceState : uint8_t { DEVICE_IDLE, DEVICE_CONNECTING, DEVICE_SENDING, DEVICE_RECEIVING };
+
+struct Device {
+  VirtualVehicle vehicle;
+  int fd = -1;
+  DeviceState state = DEVICE_IDLE;
+  uint32_t serial = 0;          // Matches timeout entries to the request they were set for
+  bool reused = false;          // Request went out on a kept-alive connection
+  uint64_t dueUs = 0;
+  uint64_t startUs = 0;
+  std::string request;
+  size_t sent = 0;
+  std::string response;
+
+  Device(uint32_t index, uint32_t seed) : vehicle(index, seed) {}
+};
+
+struct Totals {
+  uint64_t sent = 0, ok = 0, httpErrors = 0, connectErrors = 0, ioErrors = 0, timeouts = 0;
+  uint64_t late = 0, connects = 0, retries = 0, payloadBytes = 0;
+  std::vector<uint32_t> latencyUs;
+};
+
+double percentile(std::vector<uint32_t> &sorted, double p) {
+  if (sorted.empty()) return 0;
+  const size_t i = std::min(sorted.size() - 1, (size_t)(p / 100.0 * sorted.size()));
+  return sorted[i] / 1000.0;
+}
+
+class LoadGenerator {
+ public:
+  LoadGenerator(const Options &options, const sockaddr_storage &address, socklen_t addressLength)
+      : options_(options), address_(address), addressLength_(addressLength) {}
+
+  void run() {
+    epollFd_ = epoll_create1(0);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> phase(0, options_.intervalMs * 1000);
+    const uint64_t start = now_us();
+    devices_.reserve(options_.devices);
+    for (int i = 0; i < options_.devices; i++) {
+      devices_.emplace_back(i, rng());
+      devices_[i].dueUs = start + phase(rng);
+      due_.push({devices_[i].dueUs, (uint32_t)i});
+    }
+
+    const uint64_t endUs = start + (uint64_t)options_.durationS * 1000000;
+    const uint64_t drainUs = endUs + (uint64_t)options_.timeoutMs * 1000;
+    uint64_t nextReportUs = start + 1000000;
+    std::vector<epoll_event> events(4096);
+
+    while (true) {
+      uint64_t now = now_us();
+      if (now >= endUs && inFlight_ == 0) break;
+      if (now >= drainUs) break;
+
+      while (!due_.empty() && due_.top().first <= now) {
+        const uint32_t index = due_.top().second;
+        due_.pop();
+        if (now < endUs) begin_request(index, now);
+      }
+      while (!deadlines_.empty() && deadlines_.top().dueUs <= now) {
+        const Deadline deadline = deadlines_.top();
+        deadlines_.pop();
+        Device &device = devices_[deadline.index];
+        if (device.state != DEVICE_IDLE && device.serial == deadline.serial) {
+          totals_.timeouts++;
+          finish(deadline.index, now, false, false);
+        }
+      }
+
+      if (now >= nextReportUs) {
+        report_second((nextReportUs - start) / 1000000);
+        nextReportUs += 1000000;
+      }
+
+      uint64_t wakeUs = nextReportUs;
+      if (!due_.empty()) wakeUs = std::min(wakeUs, due_.top().first);
+      if (!deadlines_.empty()) wakeUs = std::min(wakeUs, deadlines_.top().dueUs);
+      const int timeoutMs = wakeUs > now ? (int)((wakeUs - now + 999) / 1000) : 0;
+      const int n = epoll_wait(epollFd_, events.data(), (int)events.size(), timeoutMs);
+      now = now_us();
+      for (int i = 0; i < n; i++) handle(events[i].data.u32, events[i].events, now);
+    }
+
+    for (Device &device : devices_) {
+      if (device.fd >= 0) close(device.fd);
+    }
+    close(epollFd_);
+    elapsedS_ = (now_us() - start) / 1e6;
+  }
+
+  void print_summary() {
+    Totals &t = totals_;
+    const double targetRps = options_.devices * 1000.0 / options_.intervalMs;
+    const uint64_t errors = t.httpErrors + t.connectErrors + t.ioErrors + t.timeouts;
+    std::sort(t.latencyUs.begin(), t.latencyUs.end());
+    double mean = 0;
+    for (uint32_t v : t.latencyUs) mean += v;
+    mean = t.latencyUs.empty() ? 0 : mean / t.latencyUs.size() / 1000.0;
+
+    printf("\n%d devices every %d ms +-%d%% for %d s (%s): target %.1f req/s\n", options_.devices,
+           options_.intervalMs, options_.jitterPct, options_.durationS,
+           options_.keepAlive ? "keep-alive" : "connection per request", targetRps);
+    printf("requests: %llu sent, %llu ok, %.1f req/s achieved | %llu late (previous post still in flight),"
+           " %llu resent after a stale keep-alive\n",
+           (unsigned long long)t.sent, (unsigned long long)t.ok, t.ok / (double)options_.durationS,
+           (unsigned long long)t.late, (unsigned long long)t.retries);
+    printf("errors: %.2f%% | http %llu, connect %llu, reset/closed %llu, timeout %llu | %llu connections opened\n",
+           t.sent ? errors * 100.0 / t.sent : 0.0, (unsigned long long)t.httpErrors,
+           (unsigned long long)t.connectErrors, (unsigned long long)t.ioErrors, (unsigned long long)t.timeouts,
+           (unsigned long long)t.connects);
+    printf("latency (ms, ok requests): mean %.2f | p50 %.2f, p90 %.2f, p99 %.2f, p99.9 %.2f, max %.2f\n", mean,
+           percentile(t.latencyUs, 50), percentile(t.latencyUs, 90), percentile(t.latencyUs, 99),
+           percentile(t.latencyUs, 99.9), t.latencyUs.empty() ? 0.0 : t.latencyUs.back() / 1000.0);
+    printf("payload: %.0f bytes mean, %.1f KB/s uploaded\n", t.sent ? t.payloadBytes / (double)t.sent : 0.0,
+           t.payloadBytes / 1024.0 / elapsedS_);
+  }
+
+ private:
+  struct Deadline {
+    uint64_t dueUs;
+    uint32_t index;
+    uint32_t serial;
+    bool operator>(const Deadline &other) const { return dueUs > other.dueUs; }
+  };
+
+  void begin_request(uint32_t index, uint64_t now) {
+    Device &device = devices_[index];
+    static char body[TELEMETRY_PAYLOAD_MAX];
+    const size_t length = device.vehicle.payload(body, sizeof(body), options_.intervalMs);
+    char head[256];
+    const int headLength = snprintf(head, sizeof(head),
+                                    "POST %s HTTP/1.1\r\nHost: %s:%s\r\nContent-Type: application/json\r\n"
+                                    "Content-Length: %zu\r\nConnection: %s\r\n\r\n",
+                                    options_.path.c_str(), options_.host.c_str(), options_.port.c_str(), length,
+                                    options_.keepAlive ? "keep-alive" : "close");
+    device.request.assign(head, headLength);
+    device.request.append(body, length);
+    device.sent = 0;
+    device.response.clear();
+    device.startUs = now;
+    device.serial++;
+    totals_.sent++;
+    window_.sent++;
+    totals_.payloadBytes += length;
+    inFlight_++;
+    deadlines_.push({now + (uint64_t)options_.timeoutMs * 1000, index, device.serial});
+    device.reused = device.fd >= 0;
+    if (device.reused) {
+      device.state = DEVICE_SENDING;
+      watch(index, EPOLLOUT, EPOLL_CTL_MOD);
+    } else {
+      open_connection(index, now);
+    }
+  }
+
+  void open_connection(uint32_t index, uint64_t now) {
+    Device &device = devices_[index];
+    device.fd = socket(address_.ss_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    totals_.connects++;
+    if (device.fd < 0) {
+      totals_.connectErrors++;
+      finish(index, now, false, false);
+      return;
+    }
+    int one = 1;
+    setsockopt(device.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(device.fd, (const sockaddr *)&address_, addressLength_) != 0 && errno != EINPROGRESS) {
+      totals_.connectErrors++;
+      finish(index, now, false, false);
+      return;
+    }
+    device.state = DEVICE_CONNECTING;
+    watch(index, EPOLLOUT, EPOLL_CTL_ADD);
+  }
+
+  void close_connection(Device &device) {
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, device.fd, nullptr);
+    close(device.fd);
+    device.fd = -1;
+  }
+
+  // The server may close a kept-alive connection just as the next request
+  // goes out; like HTTPClient, resend once on a fresh connection
+  void io_error(uint32_t index, uint64_t now) {
+    Device &device = devices_[index];
+    if (device.reused && device.response.empty()) {
+      totals_.retries++;
+      close_connection(device);
+      device.reused = false;
+      device.sent = 0;
+      open_connection(index, now);
+      return;
+    }
+    totals_.ioErrors++;
+    finish(index, now, false, false);
+  }
+
+  void handle(uint32_t index, uint32_t events, uint64_t now) {
+    Device &device = devices_[index];
+    if (device.state == DEVICE_IDLE) {
+      if (device.fd >= 0) close_connection(device);   // Server closed an idle connection
+      return;
+    }
+    if (device.state == DEVICE_CONNECTING) {
+      int error = 0;
+      socklen_t length = sizeof(error);
+      getsockopt(device.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+      if (error != 0 || (events & (EPOLLERR | EPOLLHUP))) {
+        totals_.connectErrors++;
+        finish(index, now, false, false);
+        return;
+      }
+      device.state = DEVICE_SENDING;
+    }
+    if (device.state == DEVICE_SENDING) {
+      while (device.sent < device.request.size()) {
+        const ssize_t n = send(device.fd, device.request.data() + device.sent, device.request.size() - device.sent,
+                               MSG_NOSIGNAL);
+        if (n > 0) {
+          device.sent += n;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          return;
+        } else {
+          io_error(index, now);
+          return;
+        }
+      }
+      device.state = DEVICE_RECEIVING;
+      watch(index, EPOLLIN, EPOLL_CTL_MOD);
+      return;
+    }
+    if (device.state != DEVICE_RECEIVING) return;
+
+    char buffer[8192];
+    bool closed = false;
+    while (true) {
+      const ssize_t n = recv(device.fd, buffer, sizeof(buffer), 0);
+      if (n > 0) {
+        device.response.append(buffer, n);
+      } else if (n == 0) {
+        closed = true;
+        break;
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      } else {
+        io_error(index, now);
+        return;
+      }
+    }
+
+    HttpHead head;
+    if (parse_head(device.response, head)) {
+      const size_t bodyLength = device.response.size() - head.bodyStart;
+      bool complete;
+      if (head.contentLength >= 0) complete = bodyLength >= (size_t)head.contentLength;
+      else if (head.chunked) complete = device.response.size() >= 5 &&
+                                        device.response.compare(device.response.size() - 5, 5, "0\r\n\r\n") == 0;
+      else complete = closed;
+      if (complete) {
+        const bool ok = head.status >= 200 && head.status < 300;
+        if (ok) {
+          totals_.latencyUs.push_back((uint32_t)(now - device.startUs));
+          window_.latencyUs.push_back((uint32_t)(now - device.startUs));
+        } else {
+          totals_.httpErrors++;
+        }
+        finish(index, now, ok, !head.close && !closed && options_.keepAlive);
+        return;
+      }
+    }
+    if (closed) io_error(index, now);
+  }
+
+  // Ends the request in flight and schedules the device's next post
+  void finish(uint32_t index, uint64_t now, bool ok, bool keepConnection) {
+    Device &device = devices_[index];
+    if (device.fd >= 0) {
+      if (keepConnection) watch(index, EPOLLIN, EPOLL_CTL_MOD);   // To notice the server closing it
+      else close_connection(device);
+    }
+    device.state = DEVICE_IDLE;
+    inFlight_--;
+    if (ok) {
+      totals_.ok++;
+      window_.ok++;
+    }
+
+    // The firmware posts again once the interval has passed, or at once if
+    // the previous post took longer than that
+    std::uniform_int_distribution<int> jitter(-options_.jitterPct, options_.jitterPct);
+    const int64_t periodUs = (int64_t)options_.intervalMs * (100 + jitter(device.vehicle.rng)) * 10;
+    device.dueUs += periodUs;
+    if (device.dueUs < now) {
+      device.dueUs = now;
+      totals_.late++;
+    }
+    due_.push({device.dueUs, index});
+  }
+
+  void watch(uint32_t index, uint32_t events, int op) {
+    epoll_event event = {};
+    event.events = events;
+    event.data.u32 = index;
+    epoll_ctl(epollFd_, op, devices_[index].fd, &event);
+  }
+
+  void report_second(uint64_t second) {
+    std::sort(window_.latencyUs.begin(), window_.latencyUs.end());
+    printf("[%3llus] sent %5llu/s, ok %5llu/s, in flight %5llu | p50 %.2f ms, p99 %.2f ms | errors %llu\n",
+           (unsigned long long)second, (unsigned long long)window_.sent, (unsigned long long)window_.ok,
+           (unsigned long long)inFlight_, percentile(window_.latencyUs, 50), percentile(window_.latencyUs, 99),
+           (unsigned long long)(totals_.httpErrors + totals_.connectErrors + totals_.ioErrors + totals_.timeouts));
+    window_ = Totals();
+  }
+
+  const Options &options_;
+  sockaddr_storage address_;
+  socklen_t addressLength_;
+  int epollFd_ = -1;
+  std::vector<Device> devices_;
+  std::priority_queue<std::pair<uint64_t, uint32_t>, std::vector<std::pair<uint64_t, uint32_t>>,
+                      std::greater<std::pair<uint64_t, uint32_t>>> due_;
+  std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines_;
+  uint64_t inFlight_ = 0;
+  Totals totals_;
+  Totals window_;
+  double elapsedS_ = 0;
+};
+
+bool parse_url(const std::string &url, Options &options) {
+  const std::string scheme = "http://";
+  if (url.compare(0, scheme.size(), scheme) != 0) {
+    fprintf(stderr, "Only http:// URLs are supported\n");
+    return false;
+  }
+  const size_t slash = url.find('/', scheme.size());
+  const std::string hostPort = url.substr(scheme.size(), slash == std::string::npos ? std::string::npos
+                                                                                    : slash - scheme.size());
+  options.path = slash == std::string::npos ? "/" : url.substr(slash);
+  const size_t colon = hostPort.rfind(':');
+  options.host = colon == std::string::npos ? hostPort : hostPort.substr(0, colon);
+  options.port = colon == std::string::npos ? "80" : hostPort.substr(colon + 1);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--url" && hasValue) {
+      if (!parse_url(argv[++i], options)) return 1;
+    } else if (arg == "--devices" && hasValue) {
+      options.devices = atoi(argv[++i]);
+    } else if (arg == "--duration" && hasValue) {
+      options.durationS = atoi(argv[++i]);
+    } else if (arg == "--interval" && hasValue) {
+      options.intervalMs = atoi(argv[++i]);
+    } else if (arg == "--jitter" && hasValue) {
+      options.jitterPct = std::min(90, std::max(0, atoi(argv[++i])));
+    } else if (arg == "--timeout" && hasValue) {
+      options.timeoutMs = atoi(argv[++i]);
+    } else if (arg == "--service-ms" && hasValue) {
+      options.serviceMs = atoi(argv[++i]);
+    } else if (arg == "--serve" && hasValue) {
+      options.servePort = atoi(argv[++i]);
+    } else if (arg == "--close") {
+      options.keepAlive = false;
+    } else if (arg == "--local") {
+      options.local = true;
+    } else {
+      fprintf(stderr,
+              "usage: %s [--url http://host:port/path | --local] [--devices N] [--duration S] [--interval MS]\n"
+              "          [--jitter PCT] [--timeout MS] [--close] [--service-ms MS]\n"
+              "       %s --serve PORT [--service-ms MS]\n",
+              argv[0], argv[0]);
+      return 1;
+    }
+  }
+  if (options.devices < 1 || options.durationS < 1 || options.intervalMs < 1 || options.timeoutMs < 1) {
+    fprintf(stderr, "devices, duration, interval and timeout must be positive\n");
+    return 1;
+  }
+  signal(SIGPIPE, SIG_IGN);
+  raise_fd_limit();
+
+  StandInServer server;
+  if (options.servePort) {
+    if (!server.start(options.servePort, options.serviceMs)) return 1;
+    printf("Stand-in /api/sensor server on 127.0.0.1:%d, Ctrl-C to stop\n", server.port());
+    uint64_t reported = 0;
+    while (true) {
+      sleep(5);
+      const uint64_t requests = server.requests();
+      printf("%llu requests (%.1f/s), %llu bad payloads\n", (unsigned long long)requests,
+             (requests - reported) / 5.0, (unsigned long long)server.badPayloads());
+      reported = requests;
+    }
+  }
+  if (options.local) {
+    if (!server.start(0, options.serviceMs)) return 1;
+    options.host = "127.0.0.1";
+    options.port = std::to_string(server.port());
+  }
+
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *resolved = nullptr;
+  if (getaddrinfo(options.host.c_str(), options.port.c_str(), &hints, &resolved) != 0 || !resolved) {
+    fprintf(stderr, "Cannot resolve %s:%s\n", options.host.c_str(), options.port.c_str());
+    return 1;
+  }
+  sockaddr_storage address = {};
+  memcpy(&address, resolved->ai_addr, resolved->ai_addrlen);
+  const socklen_t addressLength = resolved->ai_addrlen;
+  freeaddrinfo(resolved);
+
+  printf("Posting to http://%s:%s%s%s\n", options.host.c_str(), options.port.c_str(), options.path.c_str(),
+         options.local ? " (built-in stand-in server)" : "");
+  LoadGenerator generator(options, address, addressLength);
+  generator.run();
+  generator.print_summary();
+
+  if (options.local) {
+    server.stop();
+    printf("stand-in server: %llu requests, %llu bad payloads, %.0f bytes mean\n",
+           (unsigned long long)server.requests(), (unsigned long long)server.badPayloads(),
+           server.requests() ? server.bytes() / (double)server.requests() : 0.0);
+  }
+  return 0;
+}
@@ -0,0 +1,188 @@
+// Local stand-in for the backend's /stream WebSocket endpoint. Acknowledges
+// every sensor frame (the device measures round-trip latency from the acks),
+// relays frames to any other connected client such as the dashboard (with
+// its own receive time added as server_utc_us), and sends commands typed on
+// stdin to the device.
+//
+// No npm dependencies:
+//   node tools/stream_echo_server.js [--port 8080] [--ack-delay 0]
+//
+// Point the firmware at it with STREAM_HOST "<this machine's IP>",
+// STREAM_PORT 8080 and STREAM_USE_TLS 0, and the dashboard with
+// REACT_APP_STREAM_URL=ws://localhost:8080/stream.
+// stdin commands: "rate <hz>", "ping".
+// --ack-delay (ms) simulates a slow link to exercise coalescing.
+
+const http = require('http');
+const crypto = require('crypto');
+const readline = require('readline');
+
+const args = process.argv.slice(2);
+const option = (name, fallback) => {
+  const i = args.indexOf(name);
+  return i >= 0 && args[i + 1] !== undefined ? Number(args[i + 1]) : fallback;
+};
+const PORT = option('--port', 8080);
+const ACK_DELAY_MS = option('--ack-delay', 0);
+const STREAM_PATH = '/stream';
+const WS_GUID = '258EAFA5-E914-47DA-95CA-C5AB0DC85B11';
+
+const clients = new Set();
+let nextCommandId = 1;
+
+function encodeFrame(opcode, payload) {
+  const length = payload.length;
+  let header;
+  if (length < 126) {
+    header = Buffer.from([0x80 | opcode, length]);
+  } else if (length < 65536) {
+    header = Buffer.alloc(4);
+    header[0] = 0x80 | opcode;
+    header[1] = 126;
+    header.writeUInt16BE(length, 2);
+  } else {
+    header = Buffer.alloc(10);
+    header[0] = 0x80 | opcode;
+    header[1] = 127;
+    header.writeBigUInt64BE(BigInt(length), 2);
+  }
+  return Buffer.concat([header, payload]);
+}
+
+function sendText(client, text) {
+  if (!client.socket.destroyed) {
+    client.socket.write(encodeFrame(0x1, Buffer.from(text)));
+  }
+}
+
+// Pulls complete frames out of the client's receive buffer
+function parseFrames(client, onMessage) {
+  for (;;) {
+    const buf = client.buffer;
+    if (buf.length < 2) return;
+    const opcode = buf[0] & 0x0f;
+    const masked = (buf[1] & 0x80) !== 0;
+    let length = buf[1] & 0x7f;
+    let offset = 2;
+    if (length === 126) {
+      if (buf.length < 4) return;
+      length = buf.readUInt16BE(2);
+      offset = 4;
+    } else if (length === 127) {
+      if (buf.length < 10) return;
+      length = Number(buf.readBigUInt64BE(2));
+      offset = 10;
+    }
+    const maskOffset = offset;
+    if (masked) offset += 4;
+    if (buf.length < offset + length) return;
+
+    const payload = Buffer.from(buf.subarray(offset, offset + length));
+    if (masked) {
+      for (let i = 0; i < payload.length; i++) payload[i] ^= buf[maskOffset + (i % 4)];
+    }
+    client.buffer = buf.subarray(offset + length);
+    onMessage(opcode, payload);
+  }
+}
+
+function handleMessage(client, text) {
+  let msg;
+  try {
+    msg = JSON.parse(text);
+  } catch (err) {
+    console.log(`[${client.id}] Non-JSON message ignored`);
+    return;
+  }
+
+  if (msg.t === 'sensor') {
+    client.isDevice = true;
+    const stats = client.stats;
+    stats.frames++;
+    if (stats.lastSeq && msg.seq > stats.lastSeq + 1) stats.gaps += msg.seq - stats.lastSeq - 1;
+    stats.lastSeq = msg.seq;
+
+    const ack = JSON.stringify({ t: 'ack', seq: msg.seq });
+    if (ACK_DELAY_MS > 0) setTimeout(() => sendText(client, ack), ACK_DELAY_MS);
+    else sendText(client, ack);
+
+    // Stamp frames from a device with a synced clock, so the dashboard can
+    // tell the uplink from the relay in the pipeline latency
+    const relayed = msg.utc_us ? JSON.stringify({ ...msg, server_utc_us: Date.now() * 1000 }) : text;
+    for (const other of clients) {
+      if (other !== client && !other.isDevice) sendText(other, relayed);
+    }
+  } else if (msg.t === 'cmd_ack') {
+    console.log(`[${client.id}] Command ${msg.id} ${msg.ok ? 'ok' : 'rejected'}`, msg);
+  } else {
+    console.log(`[${client.id}]`, msg);
+  }
+}
+
+const server = http.createServer((req, res) => {
+  res.writeHead(426, { 'Content-Type': 'text/plain' });
+  res.end('WebSocket endpoint: ' + STREAM_PATH + '\n');
+});
+
+server.on('upgrade', (req, socket) => {
+  const key = req.headers['sec-websocket-key'];
+  if (!req.url.startsWith(STREAM_PATH) || !key) {
+    socket.end('HTTP/1.1 400 Bad Request\r\n\r\n');
+    return;
+  }
+  const accept = crypto.createHash('sha1').update(key + WS_GUID).digest('base64');
+  socket.write('HTTP/1.1 101 Switching Protocols\r\n' +
+               'Upgrade: websocket\r\nConnection: Upgrade\r\n' +
+               `Sec-WebSocket-Accept: ${accept}\r\n\r\n`);
+  socket.setNoDelay(true);
+
+  const client = {
+    id: `${socket.remoteAddress}:${socket.remotePort}`,
+    socket,
+    buffer: Buffer.alloc(0),
+    isDevice: false,
+    stats: { frames: 0, gaps: 0, lastSeq: 0 },
+  };
+  clients.add(client);
+  console.log(`[${client.id}] Connected`);
+
+  socket.on('data', (chunk) => {
+    client.buffer = Buffer.concat([client.buffer, chunk]);
+    parseFrames(client, (opcode, payload) => {
+      if (opcode === 0x1) handleMessage(client, payload.toString());
+      else if (opcode === 0x9) socket.write(encodeFrame(0xA, payload));
+      else if (opcode === 0x8) socket.end(encodeFrame(0x8, Buffer.alloc(0)));
+    });
+  });
+  socket.on('close', () => {
+    clients.delete(client);
+    console.log(`[${client.id}] Disconnected`);
+  });
+  socket.on('error', () => socket.destroy());
+});
+
+// Per-device frame rate and sequence gaps (gaps are frames the device coalesced)
+setInterval(() => {
+  for (const client of clients) {
+    if (!client.isDevice) continue;
+    const { frames, gaps } = client.stats;
+    console.log(`[${client.id}] ${(frames / 5).toFixed(1)} frames/s, ${gaps} seq gaps`);
+    client.stats.frames = 0;
+    client.stats.gaps = 0;
+  }
+}, 5000);
+
+readline.createInterface({ input: process.stdin }).on('line', (line) => {
+  const [cmd, value] = line.trim().split(/\s+/);
+  if (!cmd) return;
+  const message = { t: 'cmd', id: nextCommandId++, cmd };
+  if (cmd === 'rate') message.hz = Number(value);
+  for (const client of clients) {
+    if (client.isDevice) sendText(client, JSON.stringify(message));
+  }
+});
+
+server.listen(PORT, () => {
+  console.log(`Stream echo server on ws://0.0.0.0:${PORT}${STREAM_PATH}` +
+              (ACK_DELAY_MS ? ` (ack delay ${ACK_DELAY_MS} ms)` : ''));
+});
@@ -0,0 +1,434 @@
+// Replays a raw sensor trace through the firmware's detection and control
+// logic as fast as possible. Use it to regression-test algorithm changes
+// against recorded field data.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -Iinclude tools/trace_replay.cpp -o trace_replay
+//   ./trace_replay trace.bin              # replay a trace file or raw serial capture
+//   ./trace_replay trace.bin --passes 20  # repeat for a steadier throughput figure
+//   ./trace_replay --synth synth.bin 60   # write a 60 s synthetic trace
+//
+// Recorded MQ-3 curves with a known outcome are regression checks: the run
+// exits with status 2 when the alcohol decision does not match.
+//   ./trace_replay clean_drive.bin --expect-alcohol clear
+//   ./trace_replay after_drinks.bin --expect-alcohol 95   # detected within 95 s of power-on
+//
+// Traces come from a firmware build with -DSAFEDRIVE_TRACE=1 (framed records on
+// the debug serial port, capture it to a file) or -DSAFEDRIVE_TRACE=2
+// (/trace.bin on LittleFS). The decision summary is deterministic, so diffing
+// it between two builds shows exactly which decisions an algorithm change moved.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "alert_orchestrator.h"
+#include "control_logic.h"
+#include "orientation_filter.h"
+#include "sensor_trace.h"
+#include "vibration_features.h"
+
+namespace {
+
+#define ULTRASONIC_MIN_DIST 5      // Must match main.cpp
+#define ULTRASONIC_MAX_DIST 200
+#define ALCOHOL_SAMPLE_INTERVAL 100  // update_alcohol() period (ms)
+#define ACCIDENT_COOLDOWN 60000      // Must match main.cpp
+
+struct ReplayStats {
+  uint64_t records = 0, malformed = 0;
+  uint64_t samples = 0;
+  uint64_t distanceReadings = 0, distanceRejected = 0;
+  uint64_t motorStop = 0, motorSlow = 0, motorFull = 0;
+  uint64_t imuSamples = 0, brakingEvents = 0;
+  float maxAbsRoll = 0, maxAbsPitch = 0, maxImpact = 0;
+  uint64_t vibrationWindows = 0, roadSmooth = 0, roadRough = 0, roadImpact = 0;
+  uint64_t accidentLevel1 = 0, accidentLevel2 = 0;   // IMU samples at each level
+  uint32_t alertsLevel1 = 0, alertsLevel2 = 0, alertsSuppressed = 0;
+  uint64_t alcoholSamples = 0, alcoholOverThreshold = 0;
+  AlcoholStats alcohol = {};
+  int64_t alcoholFirstDetectMs = -1;   // From the first alcohol sample
+  uint8_t alcoholState = ALCOHOL_WARMING_UP;
+  float alcoholBaseline = 0;
+  uint64_t pulseSamples = 0, hallSamples = 0;
+  uint64_t nmeaBytes = 0, nmeaValid = 0, nmeaBad = 0;
+};
+
+// Per-pass algorithm state, the same objects the firmware keeps
+class ReplayPipeline {
+ public:
+  ReplayPipeline()
+      : orientation_(0.05f), vibration_(1000.0f, vibrationBandEdges), alcohol_(alcohol_config()),
+        accidentGate_(ACCIDENT_COOLDOWN) {}
+
+  void process(const TraceRecord &r, ReplayStats &st) {
+    if (!valid_length(r)) {
+      st.malformed++;
+      return;
+    }
+    st.records++;
+    switch (r.type) {
+      case TRACE_ULTRASONIC: {
+        TraceUltrasonic echo;
+        memcpy(&echo, r.payload, sizeof(echo));
+        st.samples++;
+        st.distanceReadings++;
+        if (echo.distanceCm < ULTRASONIC_MIN_DIST || echo.distanceCm > ULTRASONIC_MAX_DIST) {
+          st.distanceRejected++;
+          break;
+        }
+        // The channel is the sensor index; sensor 0 is the front sensor in the default table
+        if (r.channel != 0) break;
+        distance_ = echo.distanceCm;
+        const int speed = motor_speed_for_distance(echo.distanceCm);
+        if (speed == 0) st.motorStop++;
+        else if (speed < 255) st.motorSlow++;
+        else st.motorFull++;
+        break;
+      }
+      case TRACE_IMU: {
+        TraceImu imu;
+        memcpy(&imu, r.payload, sizeof(imu));
+        st.samples++;
+        st.imuSamples++;
+        const float dt = lastImuUs_ ? (uint32_t)(r.timeUs - lastImuUs_) * 1e-6f : 0.005f;
+        lastImuUs_ = r.timeUs;
+        orientation_.update(imu.ax, imu.ay, imu.az, imu.gx, imu.gy, imu.gz, dt);
+        st.maxAbsRoll = std::fmax(st.maxAbsRoll, std::fabs(orientation_.rollDeg()));
+        st.maxAbsPitch = std::fmax(st.maxAbsPitch, std::fabs(orientation_.pitchDeg()));
+        const float impact = fastmath::sqrt(imu.ax * imu.ax + imu.ay * imu.ay + imu.az * imu.az);
+        st.maxImpact = std::fmax(st.maxImpact, impact);
+        tempC_ = imu.tempC;
+
+        // check_accident() runs on every control tick, after the IMU read
+        const int level = accident_level(distance_, roadCondition_, impact / 9.81f,
+                                         orientation_.rollDeg(), orientation_.pitchDeg());
+        if (level == ACCIDENT_LEVEL_1) st.accidentLevel1++;
+        if (level == ACCIDENT_LEVEL_2) st.accidentLevel2++;
+        if (accidentGate_.admit(level, r.timeUs / 1000)) {
+          if (level == ACCIDENT_LEVEL_2) st.alertsLevel2++;
+          else st.alertsLevel1++;
+        }
+        st.alertsSuppressed = accidentGate_.suppressed();
+        const bool decel = is_rapid_decel(imu.ax);
+        if (decel && !braking_) st.brakingEvents++;
+        braking_ = decel;
+        break;
+      }
+      case TRACE_ADC_BLOCK: {
+        const size_t count = (r.length - 2) / 2;
+        st.samples += count;
+        for (size_t i = 0; i < count; i++) {
+          uint16_t v;
+          memcpy(&v, r.payload + 2 + 2 * i, sizeof(v));
+          window_[windowFill_++] = v;
+          if (windowFill_ == VIBRATION_WINDOW) {
+            windowFill_ = 0;
+            VibrationFeatures f;
+            vibration_.analyze(window_, f);
+            st.vibrationWindows++;
+            roadCondition_ = classify_vibration(f);
+            switch (roadCondition_) {
+              case ROAD_IMPACT: st.roadImpact++; break;
+              case ROAD_ROUGH: st.roadRough++; break;
+              default: st.roadSmooth++; break;
+            }
+          }
+        }
+        break;
+      }
+      case TRACE_ADC: {
+        uint16_t v;
+        memcpy(&v, r.payload, sizeof(v));
+        st.samples++;
+        if (r.channel == TRACE_ADC_ALCOHOL) {
+          st.alcoholSamples++;
+          if (is_alcohol_detected(v)) st.alcoholOverThreshold++;
+          if (st.alcoholSamples == 1) firstAlcoholMs_ = r.timeUs / 1000;
+          st.alcoholState = alcohol_.update(r.timeUs / 1000, v, tempC_);
+          if (st.alcoholState == ALCOHOL_DETECTED && st.alcoholFirstDetectMs < 0) {
+            st.alcoholFirstDetectMs = (uint32_t)(r.timeUs / 1000 - firstAlcoholMs_);
+          }
+          st.alcohol = alcohol_.stats();
+          st.alcoholBaseline = alcohol_.baseline();
+        } else if (r.channel == TRACE_ADC_PULSE) {
+          st.pulseSamples++;
+        } else if (r.channel == TRACE_ADC_HALL) {
+          st.hallSamples++;
+        }
+        break;
+      }
+      case TRACE_NMEA:
+        st.nmeaBytes += r.length;
+        for (uint8_t i = 0; i < r.length; i++) feedNmea((char)r.payload[i], st);
+        break;
+      default:
+        break;
+    }
+  }
+
+ private:
+  static bool valid_length(const TraceRecord &r) {
+    switch (r.type) {
+      case TRACE_ULTRASONIC: return r.length == sizeof(TraceUltrasonic);
+      case TRACE_IMU: return r.length == sizeof(TraceImu);
+      case TRACE_ADC: return r.length == sizeof(uint16_t);
+      case TRACE_ADC_BLOCK: return r.length >= 4 && r.length % 2 == 0;
+      default: return true;
+    }
+  }
+
+  // Checksum-validates NMEA sentences ($...*hh)
+  void feedNmea(char c, ReplayStats &st) {
+    if (c == '$') {
+      sentence_.clear();
+      inSentence_ = true;
+      return;
+    }
+    if (!inSentence_) return;
+    if (c == '\r' || c == '\n') {
+      inSentence_ = false;
+      const size_t star = sentence_.find('*');
+      if (star == std::string::npos || star + 3 > sentence_.size()) {
+        st.nmeaBad++;
+        return;
+      }
+      uint8_t sum = 0;
+      for (size_t i = 0; i < star; i++) sum ^= (uint8_t)sentence_[i];
+      const unsigned expected = (unsigned)strtoul(sentence_.substr(star + 1, 2).c_str(), nullptr, 16);
+      if (sum == expected) st.nmeaValid++;
+      else st.nmeaBad++;
+      return;
+    }
+    if (sentence_.size() < 96) sentence_ += c;
+  }
+
+  OrientationFilter orientation_;
+  VibrationAnalyzer<VIBRATION_WINDOW> vibration_;
+  uint16_t window_[VIBRATION_WINDOW];
+  size_t windowFill_ = 0;
+  uint32_t lastImuUs_ = 0;
+  bool braking_ = false;
+  long distance_ = ULTRASONIC_MAX_DIST;   // Last in-range front reading
+  uint8_t roadCondition_ = ROAD_SMOOTH;   // Class of the last vibration window
+  AlcoholPipeline alcohol_;
+  AlertGate accidentGate_;
+  uint32_t firstAlcoholMs_ = 0;
+  float tempC_ = NAN;
+  std::string sentence_;
+  bool inSentence_ = false;
+};
+
+bool load_trace(const char *path, std::vector<TraceRecord> &records, TraceParser &parser) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  TraceRecord record;
+  uint8_t buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+    for (size_t i = 0; i < n; i++) {
+      if (parser.feed(buffer[i], record)) records.push_back(record);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+void write_record(FILE *f, uint32_t timeUs, uint8_t type, uint8_t channel, const void *payload, size_t length) {
+  TraceRecord record;
+  uint8_t frame[TRACE_MAX_FRAME];
+  if (trace_make_record(record, timeUs, type, channel, payload, length)) {
+    fwrite(frame, 1, trace_encode_frame(record, frame), f);
+  }
+}
+
+std::string nmea_sentence(const std::string &body) {
+  uint8_t sum = 0;
+  for (char c : body) sum ^= (uint8_t)c;
+  char tail[8];
+  snprintf(tail, sizeof(tail), "*%02X\r\n", sum);
+  return "$" + body + tail;
+}
+
+// Drive toward an obstacle, brake hard, hit a pothole, stay tilted on a
+// slope and bump the obstacle at 44.5 s (a level-1 accident), with a tipsy
+// driver for the last third. The MQ-3 starts cold (a high
+// reading decaying over the first ~30 s) and the cabin warms from 24 to 40 C,
+// which raises the clean-air reading. Interleaved like the firmware.
+int synthesize(const char *path, int seconds) {
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    perror(path);
+    return 1;
+  }
+  std::mt19937 rng(1234);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+
+  uint32_t version = TRACE_FORMAT_VERSION;
+  write_record(f, 0, TRACE_BOOT, 0, &version, sizeof(version));
+
+  uint16_t vibration[TRACE_ADC_BLOCK_SAMPLES];
+  int vibrationFill = 0;
+  std::string nmeaPending;
+
+  for (uint32_t ms = 0; ms < (uint32_t)seconds * 1000; ms++) {
+    const uint32_t us = ms * 1000;
+    const float t = ms / 1000.0f;
+    const float cabinC = 24.0f + 16.0f * t / seconds;
+
+    float v = 1800.0f + 120.0f * std::sin(2.0f * 3.14159265f * 45.0f * t) + 40.0f * noise(rng);
+    if (ms >= 20000 && ms < 20040) v += 1500.0f * std::exp(-(ms - 20000) / 10.0f);
+    if (ms >= 44500 && ms < 44540) v += 1500.0f * std::exp(-(ms - 44500) / 10.0f);
+    vibration[vibrationFill++] = (uint16_t)std::fmin(std::fmax(v, 0.0f), 4095.0f);
+    if (vibrationFill == TRACE_ADC_BLOCK_SAMPLES) {
+      uint8_t payload[TRACE_MAX_PAYLOAD];
+      const uint16_t period = 1000;
+      memcpy(payload, &period, 2);
+      memcpy(payload + 2, vibration, sizeof(vibration));
+      write_record(f, us, TRACE_ADC_BLOCK, TRACE_ADC_VIBRATION, payload, 2 + sizeof(vibration));
+      vibrationFill = 0;
+    }
+
+    if (ms % 5 == 0) {
+      const float slope = t > 30.0f ? 0.2f : 0.0f;
+      const float brake = (t > 15.0f && t < 16.0f) ? -40.0f : 0.0f;
+      TraceImu imu = {-9.81f * std::sin(slope) + brake + 0.3f * noise(rng),
+                      0.3f * noise(rng),
+                      9.81f * std::cos(slope) + 0.3f * noise(rng),
+                      0.01f * noise(rng), 0.01f * noise(rng), 0.01f * noise(rng), cabinC};
+      write_record(f, us, TRACE_IMU, 0, &imu, sizeof(imu));
+
+      const float approach = 220.0f - 12.0f * std::fmod(t, 15.0f);
+      TraceUltrasonic echo = {(int32_t)(approach + 2.0f * noise(rng))};
+      write_record(f, us + 200, TRACE_ULTRASONIC, 0, &echo, sizeof(echo));
+    }
+
+    if (ms % ALCOHOL_SAMPLE_INTERVAL == 0) {
+      const float tipsyT = t - 2.0f * seconds / 3.0f;
+      const float exposure = tipsyT > 0 ? 350.0f * (1.0f - std::exp(-tipsyT / 3.0f)) : 0.0f;
+      const float air = (250.0f + exposure) * (1.0f + ALCOHOL_TEMP_COEFF * (cabinC - ALCOHOL_REF_TEMP));
+      uint16_t raw = (uint16_t)(air + 900.0f * std::exp(-t / 8.0f) + 15.0f * noise(rng));
+      write_record(f, us, TRACE_ADC, TRACE_ADC_ALCOHOL, &raw, sizeof(raw));
+      uint16_t hall = 1500;
+      write_record(f, us, TRACE_ADC, TRACE_ADC_HALL, &hall, sizeof(hall));
+    }
+    if (ms % 20 == 0) {
+      uint16_t pulse = (uint16_t)(900 + 300 * std::sin(2.0f * 3.14159265f * 1.2f * t));
+      write_record(f, us, TRACE_ADC, TRACE_ADC_PULSE, &pulse, sizeof(pulse));
+    }
+
+    if (ms % 1000 == 0) {
+      char body[128];
+      const int sec = ms / 1000;
+      snprintf(body, sizeof(body), "GPGGA,1200%02d.00,0537.%05d,N,00011.%05d,W,1,08,0.9,45.0,M,0.0,M,,",
+               sec % 60, 10000 + sec * 7, 20000 + sec * 5);
+      nmeaPending += nmea_sentence(body);
+      snprintf(body, sizeof(body), "GPRMC,1200%02d.00,A,0537.%05d,N,00011.%05d,W,25.0,90.0,191026,,,A",
+               sec % 60, 10000 + sec * 7, 20000 + sec * 5);
+      nmeaPending += nmea_sentence(body);
+    }
+    // The UART drains about one byte per millisecond at 9600 baud
+    if (!nmeaPending.empty() && ms % 64 == 63) {
+      const size_t chunk = nmeaPending.size() < TRACE_MAX_PAYLOAD ? nmeaPending.size() : TRACE_MAX_PAYLOAD;
+      write_record(f, us, TRACE_NMEA, 0, nmeaPending.data(), chunk);
+      nmeaPending.erase(0, chunk);
+    }
+  }
+
+  const long size = ftell(f);
+  fclose(f);
+  printf("Wrote %d s synthetic trace to %s (%ld bytes)\n", seconds, path, size);
+  return 0;
+}
+
+void print_summary(const ReplayStats &st) {
+  printf("records %llu (%llu malformed), samples %llu\n", (unsigned long long)st.records,
+         (unsigned long long)st.malformed, (unsigned long long)st.samples);
+  printf("ultrasonic: %llu readings, %llu rejected | motor stop %llu, slow %llu, full %llu\n",
+         (unsigned long long)st.distanceReadings, (unsigned long long)st.distanceRejected,
+         (unsigned long long)st.motorStop, (unsigned long long)st.motorSlow, (unsigned long long)st.motorFull);
+  printf("imu: %llu samples, %llu braking events, max |roll| %.1f deg, max |pitch| %.1f deg, max impact %.1f m/s^2\n",
+         (unsigned long long)st.imuSamples, (unsigned long long)st.brakingEvents,
+         st.maxAbsRoll, st.maxAbsPitch, st.maxImpact);
+  printf("vibration: %llu windows | smooth %llu, rough %llu, impact %llu\n",
+         (unsigned long long)st.vibrationWindows, (unsigned long long)st.roadSmooth,
+         (unsigned long long)st.roadRough, (unsigned long long)st.roadImpact);
+  printf("accident: level 1 on %llu IMU samples, level 2 on %llu | alerts: level 1 %u, level 2 %u, %u suppressed by cooldown\n",
+         (unsigned long long)st.accidentLevel1, (unsigned long long)st.accidentLevel2,
+         st.alertsLevel1, st.alertsLevel2, st.alertsSuppressed);
+  printf("alcohol: %llu samples, %llu raw over threshold | warm-up %u ms, %u detections, %u rejected by debounce,"
+         " first at %.1f s, detected for %.1f s, ending %s (baseline %.0f)\n",
+         (unsigned long long)st.alcoholSamples, (unsigned long long)st.alcoholOverThreshold,
+         st.alcohol.warmupMs, st.alcohol.detections, st.alcohol.rejected,
+         st.alcoholFirstDetectMs < 0 ? -1.0 : st.alcoholFirstDetectMs / 1000.0, st.alcohol.detectedMs / 1000.0,
+         st.alcoholState == ALCOHOL_DETECTED ? "detected" : st.alcoholState == ALCOHOL_CLEAR ? "clear" : "warming up",
+         st.alcoholBaseline);
+  printf("pulse %llu samples | hall %llu samples\n",
+         (unsigned long long)st.pulseSamples, (unsigned long long)st.hallSamples);
+  printf("gps: %llu bytes, %llu valid sentences, %llu bad\n",
+         (unsigned long long)st.nmeaBytes, (unsigned long long)st.nmeaValid, (unsigned long long)st.nmeaBad);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc >= 3 && strcmp(argv[1], "--synth") == 0) {
+    return synthesize(argv[2], argc >= 4 ? atoi(argv[3]) : 60);
+  }
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <trace> [--passes N] [--expect-alcohol clear|SECONDS]\n"
+                    "       %s --synth <out> [seconds]\n", argv[0], argv[0]);
+    return 1;
+  }
+  int passes = 1;
+  const char *expectAlcohol = nullptr;
+  for (int i = 2; i + 1 < argc; i++) {
+    if (strcmp(argv[i], "--passes") == 0) passes = atoi(argv[i + 1]);
+    if (strcmp(argv[i], "--expect-alcohol") == 0) expectAlcohol = argv[i + 1];
+  }
+  if (passes < 1) passes = 1;
+
+  std::vector<TraceRecord> records;
+  TraceParser parser;
+  if (!load_trace(argv[1], records, parser)) return 1;
+  printf("Loaded %zu records (%u bad frames, %u non-trace bytes skipped)\n",
+         records.size(), parser.badFrames(), parser.skippedBytes());
+  if (records.empty()) return 1;
+
+  ReplayStats summary;
+  double seconds = 0;
+  for (int pass = 0; pass < passes; pass++) {
+    ReplayStats stats;
+    ReplayPipeline pipeline;
+    const auto start = std::chrono::steady_clock::now();
+    for (const TraceRecord &r : records) pipeline.process(r, stats);
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (pass == 0) summary = stats;
+  }
+
+  print_summary(summary);
+  printf("throughput: %.2f M samples/s, %.2f M records/s over %d pass(es)\n",
+         summary.samples * passes / seconds / 1e6, summary.records * passes / seconds / 1e6, passes);
+
+  if (expectAlcohol && strcmp(expectAlcohol, "clear") == 0) {
+    if (summary.alcoholFirstDetectMs >= 0) {
+      printf("FAIL: alcohol detected at %.1f s, expected clear\n", summary.alcoholFirstDetectMs / 1000.0);
+      return 2;
+    }
+  } else if (expectAlcohol) {
+    const double bySeconds = atof(expectAlcohol);
+    if (summary.alcoholFirstDetectMs < 0 || summary.alcoholFirstDetectMs > bySeconds * 1000.0) {
+      printf("FAIL: alcohol not detected within %.1f s\n", bySeconds);
+      return 2;
+    }
+  }
+  return 0;
+}